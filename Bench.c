@@ -0,0 +1,277 @@
+#include "Bench.h"
+#include "Board.h"
+#include "Evaluation.h"
+#include "FEN.h"
+#include "MoveLine.h"
+#include "Options.h"
+#include "Profiler.h"
+#include "Repetition.h"
+#include "SearchStats.h"
+#include "Timer.h"
+#include "Transposition.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+// Middle games, end games (including tablebase material), checks, mates and stalemates. The starting position is left
+// out, since it is answered from the opening book without a search.
+static const char * s_benchPositions[] =
+{
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 11",
+    "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+    "rq3rk1/ppp2ppp/1bnpb3/3N2B1/3NP3/7P/PPPQ1PP1/2KR3R w - - 7 14",
+    "r1bq1r1k/1pp1n1pp/1p1p4/4p2Q/4Pp2/1BNP4/PPP2PPP/3R1RK1 w - - 2 14",
+    "r3r1k1/2p2ppp/p1p1bn2/8/1q2P3/2NPQN2/PPP3PP/R4RK1 b - - 2 15",
+    "r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
+    "r1bq1rk1/ppp1nppp/4n3/3p3Q/3P4/1BP1B3/PP1N2PP/R4RK1 w - - 1 16",
+    "4r1k1/r1q2ppp/ppp2n2/4P3/5Rb1/1N1BQ3/PPP3PP/R5K1 w - - 1 17",
+    "2rqkb1r/ppp2p2/2npb1p1/1N1Nn2p/2P1PP2/8/PP2B1PP/R1BQK2R b KQ - 0 11",
+    "r1bq1r1k/b1p1npp1/p2p3p/1p6/3PP3/1B2NN2/PP3PPP/R2Q1RK1 w - - 1 16",
+    "3r1rk1/p5pp/bpp1pp2/8/q1PP1P2/b3P3/P2NQRPP/1R2B1K1 b - - 6 22",
+    "r1q2rk1/2p1bppp/2Pp4/p6b/Q1PNp3/4B3/PP1R1PPP/2K4R w - - 2 18",
+    "4k2r/1pb2ppp/1p2p3/1R1p4/3P4/2r1PN2/P4PPP/1R4K1 b - - 3 22",
+    "3q2k1/pb3p1p/4pbp1/2r5/PpN2N2/1P2P2P/5PP1/Q2R2K1 b - - 4 26",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4",
+    "r1b1kb1r/ppq2ppp/2n1pn2/3p4/3P1B2/2PBPN2/PP3PPP/RN1QK2R w KQkq - 3 7",
+    "r2qkbnr/ppp2ppp/2np4/4p3/2B1P1b1/5N2/PPPP1PPP/RNBQ1RK1 w kq - 2 5",
+    "rnbqk2r/ppp1bppp/4pn2/3p4/2PP4/2N2N2/PP2PPPP/R1BQKB1R w KQkq - 4 5",
+    "r1bqk2r/pp2bppp/2nppn2/8/3NP3/2N1B3/PPP1BPPP/R2QK2R w KQkq - 2 8",
+    "2r2rk1/1bqnbppp/p2ppn2/1p6/3NP3/1BN1BP2/PPPQ2PP/2KR3R w - - 4 13",
+    "5rk1/q6p/2p3bR/1pPp1rP1/1P1Pp3/P3B1Q1/1K3P2/R7 w - - 93 90",
+    "4rrk1/1p1nq3/p7/2p1P1pp/3P2bp/3Q1Bn1/PPPB4/1K2R1NR w - - 40 21",
+    "r3k2r/3nnpbp/q2pp1p1/p7/Pp1PPPP1/4BNN1/1P5P/R2Q1RK1 w kq - 0 16",
+    "3Qb1k1/1r2ppb1/pN1n2q1/Pp1Pp1Pr/4P2p/4BP2/4B1R1/1R5K b - - 11 40",
+    "4k3/3q1r2/1N2r1b1/3ppN2/2nPP3/1B1R2n1/2R1Q3/3K4 w - - 5 1",
+    "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/8 b - - 0 1",
+    "3b4/5kp1/1p1p1p1p/pP1PpP1P/P1P1P3/3KN3/8/8 w - - 0 1",
+    "2K5/p7/7P/5pR1/8/5k2/r7/8 w - - 0 1",
+    "8/6pk/1p6/8/PP3p1p/5P2/4KP1q/3Q4 w - - 0 1",
+    "7k/3p2pp/4q3/8/4Q3/5Kp1/P6b/8 w - - 0 1",
+    "8/2p5/8/2kPKp1p/2p4P/2P5/3P4/8 w - - 0 1",
+    "8/1p3pp1/7p/5P1P/2k3P1/8/2K2P2/8 w - - 0 1",
+    "8/pp2r1k1/2p1p3/3pP2p/1P1P1P1P/P5KR/8/8 w - - 0 1",
+    "8/3p4/p1bk3p/Pp6/1Kp1PpPp/2P2P1P/2P5/5B2 b - - 0 1",
+    "5k2/7R/4P2p/5K2/p1r2P1p/8/8/8 b - - 0 1",
+    "6k1/6p1/P6p/r1N5/5p2/7P/1b3PP1/4R1K1 w - - 0 1",
+    "1r3k2/4q3/2Pp3b/3Bp3/2Q2p2/1p1P2P1/1P2KP2/3N4 w - - 0 1",
+    "6k1/4pp1p/3p2p1/P1pPb3/R7/1r2P1PP/3B1P2/6K1 w - - 0 1",
+    "8/3p3B/5p2/5P2/p7/PP5b/k7/6K1 w - - 0 1",
+    "8/8/8/8/5kp1/P7/8/1K1N4 w - - 0 1",
+    "8/8/8/5N2/8/p7/8/2NK3k w - - 0 1",
+    "8/3k4/8/8/8/4B3/4KB2/2B5 w - - 0 1",
+    "8/8/1P6/5pr1/8/4R3/7k/2K5 w - - 0 1",
+    "8/2p4P/8/kr6/6R1/8/8/1K6 w - - 0 1",
+    "8/8/3P3k/8/1p6/8/1P6/1K3n2 b - - 0 1",
+    "8/R7/2q5/8/6k1/8/1P5p/K6R w - - 0 124",
+    "6k1/3b3r/1p1p4/p1n2p2/1PPNpP1q/P3Q1p1/1R1RB1P1/5K2 b - - 0 1", // Mate in one.
+    "r2r1n2/pp2bk2/2p1p2p/3q4/3PN1QP/2P3R1/P4PP1/5RK1 w - - 0 1", // Checks everywhere.
+    "8/8/8/8/8/6k1/6p1/6K1 w - - 0 1", // Stalemate.
+    "7k/7P/6K1/8/3B4/8/8/8 b - - 0 1", // Stalemate.
+};
+
+#define NUM_BENCH_POSITIONS (sizeof(s_benchPositions) / sizeof(s_benchPositions[0]))
+
+size_t BenchGetNumPositions()
+{
+    return NUM_BENCH_POSITIONS;
+}
+
+const char * BenchGetPosition(size_t index)
+{
+    return (index < NUM_BENCH_POSITIONS) ? s_benchPositions[index] : NULL;
+}
+
+typedef struct
+{
+    uint64_t nodes;
+    uint64_t microseconds;
+    uint64_t ttProbes;
+    uint64_t ttHits;
+    ProfileCounters profile;
+    SearchStats searchStats;
+} BenchResult;
+
+// Searches all bench positions to the given depth with the current transposition table.
+static bool BenchRun(uint32_t depth, bool verbose, BenchResult * result)
+{
+    memset(result, 0, sizeof(BenchResult));
+
+    RepetitionStack history;
+    if (!RepetitionStackInitialize(&history, 16))
+        return false;
+
+    // The per-iteration info lines are not interesting here.
+    bool debugMode = g_optionDebugMode;
+    g_optionDebugMode = false;
+
+    for (size_t i = 0; i < NUM_BENCH_POSITIONS; ++i)
+    {
+        Board board;
+        if (!ParseFEN(s_benchPositions[i], &board))
+            continue;
+
+        // EvalStart clears the transposition table, so every position starts from the same state.
+        MoveLine line;
+        uint64_t begin = TimerGetMicroseconds();
+        bool hasMove = EvalStart(&board, &history, 0xFFFFFFFF, depth, &line);
+        result->microseconds += TimerGetMicroseconds() - begin;
+        ProfileAccumulate(&result->profile);
+        EvalAccumulateSearchStats(&result->searchStats);
+
+        uint64_t nodes = EvalGetNodeCount();
+        result->nodes += nodes;
+
+        uint64_t ttProbes;
+        uint64_t ttHits;
+        EvalGetTTStats(&ttProbes, &ttHits);
+        result->ttProbes += ttProbes;
+        result->ttHits += ttHits;
+
+        if (verbose)
+        {
+            char moveStr[6]; // Max 5 chars plus extra character for null-termination
+            memset(moveStr, 0, sizeof(moveStr));
+            if (hasMove)
+                MoveToString(line.moves[0], moveStr, sizeof(moveStr) - 1);
+            printf("Position %2zu/%zu: %s nodes %" PRIu64 " bestmove %s\n", i + 1, NUM_BENCH_POSITIONS, s_benchPositions[i], nodes, (moveStr[0] != '\0') ? moveStr : "(none)");
+            fflush(stdout);
+        }
+    }
+
+    g_optionDebugMode = debugMode;
+    RepetitionStackDestroy(&history);
+
+    if (result->microseconds == 0)
+        result->microseconds = 1;
+    return true;
+}
+
+static bool BenchSetHashSize(uint32_t hashMB, uint32_t restoreHashMB)
+{
+    EvalDestroy();
+    if (!EvalInit(TranspositionTableConvertNumBuckets(hashMB)))
+    {
+        printf("info string Invalid bench hash size: %" PRIu32 " MB\n", hashMB);
+        EvalInit(TranspositionTableConvertNumBuckets(restoreHashMB));
+        return false;
+    }
+    return true;
+}
+
+bool Bench(uint32_t depth, uint32_t numThreads, uint32_t hashMB, uint32_t restoreHashMB)
+{
+    // The search is single threaded; the parameter is accepted so that bench command lines stay stable.
+    if (numThreads > 1)
+        printf("info string Search is single threaded; bench runs on 1 thread\n");
+
+    if (!BenchSetHashSize(hashMB, restoreHashMB))
+        return false;
+
+    BenchResult result;
+    bool success = BenchRun(depth, true, &result);
+    if (success)
+    {
+        printf("\n===========================\n");
+        printf("Total time (ms) : %" PRIu64 "\n", result.microseconds / 1000);
+        printf("Nodes searched  : %" PRIu64 "\n", result.nodes);
+        printf("Nodes/second    : %" PRIu64 "\n", (result.nodes * 1000000) / result.microseconds);
+        ProfilePrint(&result.profile);
+#if SEARCH_STATS
+        // Summed over all positions; mostly of interest for the move ordering statistics.
+        SearchStatsPrint(&result.searchStats);
+#endif
+        fflush(stdout);
+    }
+
+    EvalDestroy();
+    return EvalInit(TranspositionTableConvertNumBuckets(restoreHashMB)) && success;
+}
+
+bool BenchScaling(uint32_t depth, uint32_t maxThreads, uint32_t hashMB, uint32_t restoreHashMB)
+{
+    if (maxThreads == 0)
+        maxThreads = 1;
+
+    // The search does not take a thread count yet, so a run "with" more threads would only repeat the single threaded
+    // one under the wrong label. Until it does, only the single threaded run is made.
+    if (maxThreads > 1)
+    {
+        printf("info string Search is single threaded; scaling bench limited to 1 thread (requested %" PRIu32 ")\n", maxThreads);
+        maxThreads = 1;
+    }
+
+    // Thread counts 1, 2, 4, ..., plus maxThreads itself if it is not a power of 2.
+    uint32_t threadCounts[33];
+    BenchResult results[33];
+    uint32_t numRuns = 0;
+    for (uint32_t n = 1; n < maxThreads && numRuns < 32; n *= 2)
+        threadCounts[numRuns++] = n;
+    threadCounts[numRuns++] = maxThreads;
+
+    for (uint32_t i = 0; i < numRuns; ++i)
+    {
+        // Fresh table for every run, so that no run benefits from the one before it.
+        if (!BenchSetHashSize(hashMB, restoreHashMB))
+            return false;
+
+        printf("info string Scaling bench: %" PRIu32 " thread(s), depth %" PRIu32 "\n", threadCounts[i], depth);
+        fflush(stdout);
+        if (!BenchRun(depth, false, &results[i]))
+        {
+            EvalDestroy();
+            EvalInit(TranspositionTableConvertNumBuckets(restoreHashMB));
+            return false;
+        }
+    }
+
+    const BenchResult * base = &results[0];
+    double baseNps = (double)base->nodes / base->microseconds;
+
+    printf("\n%7s %10s %8s %12s %9s %10s %8s %8s\n", "Threads", "Time (ms)", "Speedup", "Nodes", "Overhead", "Nodes/s", "NPS x", "TT hit");
+    for (uint32_t i = 0; i < numRuns; ++i)
+    {
+        const BenchResult * r = &results[i];
+        double nps = (double)r->nodes / r->microseconds;
+        char ttHitRate[16];
+        if (r->ttProbes > 0)
+            snprintf(ttHitRate, sizeof(ttHitRate), "%.1f%%", (100.0 * r->ttHits) / r->ttProbes);
+        else
+            snprintf(ttHitRate, sizeof(ttHitRate), "off"); // The search does not probe the table (ENABLE_TT).
+        printf("%7" PRIu32 " %10" PRIu64 " %8.2f %12" PRIu64 " %9.3f %10" PRIu64 " %8.2f %8s\n",
+               threadCounts[i],
+               r->microseconds / 1000,
+               (double)base->microseconds / r->microseconds,
+               r->nodes,
+               (double)r->nodes / (base->nodes ? base->nodes : 1),
+               (uint64_t)(nps * 1000000),
+               nps / baseNps,
+               ttHitRate);
+    }
+
+    // One line per run, for scripts.
+    printf("\nthreads,time_us,speedup,nodes,overhead,nps,nps_scaling,tt_probes,tt_hits\n");
+    for (uint32_t i = 0; i < numRuns; ++i)
+    {
+        const BenchResult * r = &results[i];
+        double nps = (double)r->nodes / r->microseconds;
+        printf("%" PRIu32 ",%" PRIu64 ",%.4f,%" PRIu64 ",%.4f,%" PRIu64 ",%.4f,%" PRIu64 ",%" PRIu64 "\n",
+               threadCounts[i],
+               r->microseconds,
+               (double)base->microseconds / r->microseconds,
+               r->nodes,
+               (double)r->nodes / (base->nodes ? base->nodes : 1),
+               (uint64_t)(nps * 1000000),
+               nps / baseNps,
+               r->ttProbes,
+               r->ttHits);
+    }
+    fflush(stdout);
+
+    EvalDestroy();
+    return EvalInit(TranspositionTableConvertNumBuckets(restoreHashMB));
+}
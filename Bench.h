@@ -0,0 +1,27 @@
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define BENCH_DEFAULT_DEPTH 6
+#define BENCH_DEFAULT_THREADS 1
+#define BENCH_DEFAULT_HASH_MB 16
+
+// Searches a fixed set of positions to a fixed depth, starting each one with a cleared transposition table, and prints
+// the total node count, time and nps. The node count is the bench signature: it only changes when the search does,
+// so it tells functional changes apart from pure speed changes. The transposition table is resized to hashMB for the
+// duration of the bench and restored to restoreHashMB afterwards. Returns false if the table could not be allocated.
+extern bool Bench(uint32_t depth, uint32_t numThreads, uint32_t hashMB, uint32_t restoreHashMB);
+
+// Runs the bench positions at 1, 2, 4, ... maxThreads threads and prints, for each thread count, the time-to-depth
+// speedup, nodes per second scaling, search overhead (nodes relative to 1 thread) and transposition table hit rate, as
+// a table followed by CSV lines. The search is single threaded for now, so maxThreads is limited to 1.
+extern bool BenchScaling(uint32_t depth, uint32_t maxThreads, uint32_t hashMB, uint32_t restoreHashMB);
+
+// The bench positions as FEN, for other benchmarks which want the same set of positions.
+extern size_t BenchGetNumPositions();
+extern const char * BenchGetPosition(size_t index);
+
+#endif // BENCH_H_
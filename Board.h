@@ -33,41 +33,58 @@ typedef enum
 
 } CastleBits;
 
+// Selects the board layout. The default layout keeps one set of piece tables per player plus a mailbox in two cache
+// lines; the compact layout fits in a single cache line by sharing the piece type tables between both players, at the
+// cost of an AND for every piece table lookup and no mailbox. All code goes through the accessors below, so either
+// layout can be used.
+#define BOARD_COMPACT 0
+
+#if BOARD_COMPACT
+
+// Exactly one cache line.
+typedef struct
+{
+    _Alignas(64) uint64_t playerTables[2]; // All pieces of each player, including the king.
+    uint64_t pieceTypeTables[NUM_PIECE_TABLES - 1]; // Pieces of both players, indexed by PIECE_TABLE_* - 1.
+    uint64_t hash; // Zobrist hash
+    uint16_t ply; // Number of half-moves
+    Square whiteKingSquare;
+    Square blackKingSquare;
+    Square enPassantSquare;
+    Player playerToMove;
+    uint8_t halfmoveCounter; // Counter to track fifty rule move
+    uint8_t castleBits;
+} Board;
+
+STATIC_ASSERT(sizeof(Board) == 64, "sizeof(Board) is not exactly one cache line");
+
+#else
+
 // We try to keep this struct <= 128 bytes so it can fit in two cache lines.
-//
-// TODO: REPLACE KING PIECE TABLES WITH SQUARES!
-// This will save 14 bytes at the expense of some additional bit shifts. This is almost definitely worth it so we can store material hash, player data, etc.
-//
-//
 typedef struct
 {
-    // Add one table for all pieces combined. This combined table uses index 0 so that
-    // the PieceType enum can index directly into the array.
-    // Everything is kept in arrays like this instead of being broken out to allow the compiler
-    // to pack the struct nicely and maybe take advantage of some caching benefits.
-    uint64_t whitePieceTables[NUM_PIECE_TABLES];
-    uint64_t blackPieceTables[NUM_PIECE_TABLES];
-    uint64_t allPieceTables;
+    // Indexed by [Player][PIECE_TABLE_*]. The combined table (all pieces of the player, including the king) uses
+    // index 0 so that the PieceType enum can index directly into the array.
+    _Alignas(64) uint64_t pieceTables[2][NUM_PIECE_TABLES];
     uint64_t hash; // Zobrist hash
-    uint64_t materialHash; // Simplified material hash
-    int32_t staticEval; // TODO: Remove this once we get some things settled.
+    // Piece on each square, one nibble per square: the PieceType in the low 3 bits and the Player in the high bit.
+    // Kept in sync with the piece tables so that looking up the piece on a square is a single load.
+    uint8_t mailbox[NUM_SQUARES / 2];
     uint16_t ply; // Number of half-moves
     Square whiteKingSquare;
     Square blackKingSquare;
     Square enPassantSquare;
     Player playerToMove;
-    // TODO: Since we are storing the hash here, which includes Player data, we should also include the Player here as well,
-    // rather than hauling around an addition parameter to a bunch of functions.
     uint8_t halfmoveCounter; // Counter to track fifty rule move
     uint8_t castleBits;
 } Board;
 
 STATIC_ASSERT(sizeof(Board) <= 128, "sizeof(Board) exceeds two cache lines");
 
+#endif
+
 extern void BoardInitializeStartingPosition(Board * board);
 
-extern PieceType BoardGetPieceAtSquare(const Board * board, Square square);
-extern void BoardGetPlayerPieceAtSquare(const Board * board, Square square, PieceType * type, Player * player);
 extern uint64_t BoardGetPieceTable(const Board * board, Player player, PieceType type);
 extern uint8_t BoardGetNumPieces(const Board * board, Player player, PieceType type);
 
@@ -76,4 +93,136 @@ static inline void BoardInitializeEmpty(Board * board)
     memset(board, 0, sizeof(Board));
 }
 
+// Gets one of the PIECE_TABLE_* tables of the given player.
+static inline uint64_t BoardGetPlayerPieceTable(const Board * board, Player player, int table)
+{
+#if BOARD_COMPACT
+    if (table == PIECE_TABLE_COMBINED)
+        return board->playerTables[player];
+    else
+        return board->playerTables[player] & board->pieceTypeTables[table - 1];
+#else
+    return board->pieceTables[player][table];
+#endif
+}
+
+static inline uint64_t BoardGetOccupancy(const Board * board)
+{
+#if BOARD_COMPACT
+    return board->playerTables[White] | board->playerTables[Black];
+#else
+    return board->pieceTables[White][PIECE_TABLE_COMBINED] | board->pieceTables[Black][PIECE_TABLE_COMBINED];
+#endif
+}
+
+#if !BOARD_COMPACT
+
+// Piece and player packed into a single mailbox nibble; an empty square is 0.
+static inline uint8_t BoardMakeMailboxPiece(Player player, PieceType type)
+{
+    return (uint8_t)(type | (player << 3));
+}
+
+static inline uint8_t BoardGetMailboxPiece(const Board * board, Square square)
+{
+    return (board->mailbox[square >> 1] >> ((square & 1) << 2)) & 0xF;
+}
+
+static inline void BoardSetMailboxPiece(Board * board, Square square, uint8_t piece)
+{
+    uint8_t shift = (square & 1) << 2;
+    board->mailbox[square >> 1] = (uint8_t)((board->mailbox[square >> 1] & ~(0xF << shift)) | (piece << shift));
+}
+
+#endif
+
+static inline PieceType BoardGetPieceAtSquare(const Board * board, Square square)
+{
+#if BOARD_COMPACT
+    // Branchless: a queen has both the bishop and rook bits set, so replace their sum with the queen.
+    uint8_t pawn = (board->pieceTypeTables[PIECE_TABLE_PAWNS - 1] >> square) & 1;
+    uint8_t knight = (board->pieceTypeTables[PIECE_TABLE_KNIGHTS - 1] >> square) & 1;
+    uint8_t bishop = (board->pieceTypeTables[PIECE_TABLE_BISHOPS_QUEENS - 1] >> square) & 1;
+    uint8_t rook = (board->pieceTypeTables[PIECE_TABLE_ROOKS_QUEENS - 1] >> square) & 1;
+    uint8_t king = (square == board->whiteKingSquare) | (square == board->blackKingSquare);
+    return (PieceType)(pawn * Pawn + knight * Knight + bishop * Bishop + rook * Rook - (bishop & rook) * (Bishop + Rook - Queen) + king * King);
+#else
+    return BoardGetMailboxPiece(board, square) & 0x7;
+#endif
+}
+
+// The player is only written if there is a piece on the square.
+static inline void BoardGetPlayerPieceAtSquare(const Board * board, Square square, PieceType * type, Player * player)
+{
+    *type = BoardGetPieceAtSquare(board, square);
+    if (*type != None)
+    {
+#if BOARD_COMPACT
+        *player = (board->playerTables[Black] >> square) & 1;
+#else
+        *player = BoardGetMailboxPiece(board, square) >> 3;
+#endif
+    }
+}
+
+// Toggles a piece in the piece tables, without touching the mailbox or king squares.
+static inline void BoardTogglePiece(Board * board, Player player, PieceType type, uint64_t mask)
+{
+#if BOARD_COMPACT
+    uint64_t * tables = board->pieceTypeTables;
+    const int offset = 1;
+    board->playerTables[player] ^= mask;
+#else
+    uint64_t * tables = board->pieceTables[player];
+    const int offset = 0;
+    tables[PIECE_TABLE_COMBINED] ^= mask;
+#endif
+    switch (type)
+    {
+    case Pawn:
+        tables[PIECE_TABLE_PAWNS - offset] ^= mask;
+        break;
+    case Knight:
+        tables[PIECE_TABLE_KNIGHTS - offset] ^= mask;
+        break;
+    case Bishop:
+        tables[PIECE_TABLE_BISHOPS_QUEENS - offset] ^= mask;
+        break;
+    case Rook:
+        tables[PIECE_TABLE_ROOKS_QUEENS - offset] ^= mask;
+        break;
+    case Queen:
+        tables[PIECE_TABLE_BISHOPS_QUEENS - offset] ^= mask;
+        tables[PIECE_TABLE_ROOKS_QUEENS - offset] ^= mask;
+        break;
+    }
+}
+
+// Places a piece on an empty square. Does not update the king squares.
+static inline void BoardAddPiece(Board * board, Player player, PieceType type, Square square)
+{
+    BoardTogglePiece(board, player, type, SquareEncode(square));
+#if !BOARD_COMPACT
+    BoardSetMailboxPiece(board, square, BoardMakeMailboxPiece(player, type));
+#endif
+}
+
+static inline void BoardRemovePiece(Board * board, Player player, PieceType type, Square square)
+{
+    BoardTogglePiece(board, player, type, SquareEncode(square));
+#if !BOARD_COMPACT
+    BoardSetMailboxPiece(board, square, 0);
+#endif
+}
+
+// Moves a piece to an empty square. Does not update the king squares.
+static inline void BoardMovePiece(Board * board, Player player, PieceType type, Square from, Square to)
+{
+    BoardTogglePiece(board, player, type, SquareEncode(from) | SquareEncode(to));
+#if !BOARD_COMPACT
+    BoardSetMailboxPiece(board, from, 0);
+    BoardSetMailboxPiece(board, to, BoardMakeMailboxPiece(player, type));
+#endif
+}
+
 #endif // BOARD_H_
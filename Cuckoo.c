@@ -0,0 +1,79 @@
+#include "Board.h"
+#include "Cuckoo.h"
+#include "PieceType.h"
+#include "Player.h"
+#include "Zobrist.h"
+#include "tables/MoveTables.h"
+
+#include <assert.h>
+#include <string.h>
+
+uint64_t s_cuckooKeys[CUCKOO_TABLE_SIZE];
+Square s_cuckooSquares[CUCKOO_TABLE_SIZE][2];
+
+static const uint64_t * GetEmptyBoardMoves(PieceType piece)
+{
+    switch (piece)
+    {
+    case Knight:
+        return s_knightMoveBitboard;
+    case Bishop:
+        return s_bishopMoveBitboard;
+    case Rook:
+        return s_rookMoveBitboard;
+    case Queen:
+        return s_queenMoveBitboard;
+    case King:
+    default:
+        return s_kingMoveBitboard;
+    }
+}
+
+void CuckooGenerate()
+{
+    memset(s_cuckooKeys, 0, sizeof(s_cuckooKeys));
+    memset(s_cuckooSquares, 0, sizeof(s_cuckooSquares));
+
+    uint32_t count = 0;
+    for (Player player = White; player <= Black; ++player)
+    {
+        for (PieceType piece = Knight; piece <= King; ++piece)
+        {
+            const uint64_t * moves = GetEmptyBoardMoves(piece);
+            for (Square a = 0; a < NUM_SQUARES; ++a)
+            {
+                for (Square b = a + 1; b < NUM_SQUARES; ++b)
+                {
+                    if (!(moves[a] & SquareEncode(b)))
+                        continue;
+
+                    uint64_t key = ZobristGetPieceKey(player, piece, a) ^ ZobristGetPieceKey(player, piece, b) ^ ZobristGetPlayerToMoveKey();
+                    Square squareA = a;
+                    Square squareB = b;
+
+                    // Insert, evicting whatever occupies the slot into its alternate slot until an empty slot is found.
+                    uint32_t i = CuckooHash1(key);
+                    while (true)
+                    {
+                        uint64_t evictedKey = s_cuckooKeys[i];
+                        Square evictedA = s_cuckooSquares[i][0];
+                        Square evictedB = s_cuckooSquares[i][1];
+                        s_cuckooKeys[i] = key;
+                        s_cuckooSquares[i][0] = squareA;
+                        s_cuckooSquares[i][1] = squareB;
+                        if (evictedKey == 0)
+                            break;
+                        key = evictedKey;
+                        squareA = evictedA;
+                        squareB = evictedB;
+                        i = (i == CuckooHash1(key)) ? CuckooHash2(key) : CuckooHash1(key);
+                    }
+                    count++;
+                }
+            }
+        }
+    }
+
+    assert(count == CUCKOO_NUM_MOVES);
+    (void)count;
+}
@@ -0,0 +1,52 @@
+#ifndef CUCKOO_H_
+#define CUCKOO_H_
+
+#include "Intrinsics.h"
+#include "Square.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Cuckoo tables of reversible moves, used to detect a repetition which can be reached in one move.
+// Each entry holds the Zobrist difference caused by a non-pawn piece moving between two squares
+// (including the player to move key), along with the two squares. Every reversible move has exactly
+// one entry, found in one of two slots chosen by two independent hashes of the key.
+// See "Marcel van Kervinck, Detecting upcoming repetitions" for the original idea.
+#define CUCKOO_TABLE_SIZE 0x2000
+
+// Number of distinct reversible moves for knights, bishops, rooks, queens, and kings of both players on an empty board.
+#define CUCKOO_NUM_MOVES 3668
+
+extern uint64_t s_cuckooKeys[CUCKOO_TABLE_SIZE];
+extern Square s_cuckooSquares[CUCKOO_TABLE_SIZE][2];
+
+// Must be called whenever the Zobrist keys change (i.e. from ZobristGenerate()).
+extern void CuckooGenerate();
+
+static FORCE_INLINE uint32_t CuckooHash1(uint64_t key)
+{
+    return (uint32_t)(key & (CUCKOO_TABLE_SIZE - 1));
+}
+
+static FORCE_INLINE uint32_t CuckooHash2(uint64_t key)
+{
+    return (uint32_t)((key >> 16) & (CUCKOO_TABLE_SIZE - 1));
+}
+
+// Looks up the reversible move which changes the hash by the given key. The squares are returned
+// in no particular order; the moving piece is on one of them and the other one is empty.
+static FORCE_INLINE bool CuckooLookup(uint64_t key, Square * a, Square * b)
+{
+    uint32_t i = CuckooHash1(key);
+    if (s_cuckooKeys[i] != key)
+    {
+        i = CuckooHash2(key);
+        if (s_cuckooKeys[i] != key)
+            return false;
+    }
+    *a = s_cuckooSquares[i][0];
+    *b = s_cuckooSquares[i][1];
+    return true;
+}
+
+#endif // CUCKOO_H_
@@ -1,3 +1,4 @@
+#include "Cuckoo.h"
 #include "Evaluation.h"
 #include "FEN.h"
 #include "Intrinsics.h"
@@ -7,12 +8,16 @@
 #include "MoveOrderer.h"
 #include "OpeningBook.h"
 #include "Options.h"
+#include "Profiler.h"
 #include "Repetition.h"
+#include "SearchStats.h"
+#include "SearchTrace.h"
 #include "StaticEval.h"
 #include "Syzygy.h"
 #include "Transposition.h"
 #include "Zobrist.h"
 
+#include "tables/InBetweenMasks.h"
 #include "tables/MoveTables.h"
 
 #ifdef __GNUC__
@@ -23,20 +28,6 @@
 #include <stdio.h>
 #include <time.h>
 
-#ifdef _MSC_VER
-#include "WindowsInclude.h"
-static LONGLONG s_ticks = 0;
-
-// Code for profiling a section:
-
-/*LARGE_INTEGER start, end;
-QueryPerformanceCounter(&start);
-
-QueryPerformanceCounter(&end);
-s_ticks += (end.QuadPart - start.QuadPart);*/
-
-#endif
-
 // TODO: Newer GCC versions support this, but disabled for now.
 #ifdef __GNUC__
 #define thread_local
@@ -58,31 +49,84 @@ s_ticks += (end.QuadPart - start.QuadPart);*/
 // Maximum length of search extensions, to limit things like long check sequences.
 #define SEARCH_EXTENSION_MAX 3
 
-static RepetitionTable s_repetitionTable;
+static RepetitionStack s_repetitionStack;
 static TranspositionTable s_transpositionTable;
-static uint64_t s_lmrPruning = 0;
-static uint64_t s_nullMovePruning = 0;
-static uint64_t s_repetitions = 0;
-static uint64_t s_extensions = 0;
 static uint64_t s_positionsEvaluated = 0;
-static uint64_t s_betaCutoffs = 0;
-static uint64_t s_alphaUpdates = 0;
-static uint64_t s_ttHits = 0;
+static uint64_t s_ttProbes = 0;
+static uint64_t s_ttProbeHits = 0;
 static uint64_t s_tbHits = 0;
-static uint64_t s_avgMoveOrderer = 0;
-static uint64_t s_avgMoveOrdererCnt = 0;
 static int s_selDepth = 0;
 
 // Give or take enough space for maximum number of moves for MAX_LINE_DEPTH * 2 consecutive ply, which should be enough for any reasonably conceivable position.
-static thread_local Move s_moves[MAX_LINE_DEPTH * 256 * 2];
-static thread_local int32_t s_approxMoveScores[MAX_LINE_DEPTH * 256 * 2];
+// Sort keys of the moves at every node on the current line; see MoveOrderer. Each node's moves are stacked on top of its parent's.
+static thread_local uint32_t s_moveKeys[MAX_LINE_DEPTH * 256 * 2];
+// Scratch space for the move generator; the moves are turned into sort keys before the node recurses.
+static thread_local Move s_generatedMoves[256];
 // TODO: Need to limit q-search to a certain ply to prevent overflow in s_moveLines.
 static thread_local MoveLine s_moveLines[MAX_LINE_DEPTH * 2]; // Need some extra room for extra ply in quiescence search
 // TODO: This might not need to be thread_local.
-static thread_local KillerMoves s_killerMoves[MAX_LINE_DEPTH];
+static thread_local KillerMoves s_killerMoves[MAX_LINE_DEPTH * 2]; // Same extra room as s_moveLines, for quiescence search.
+
+// Per-ply data which is computed once per node and shared by everything that needs it at that node.
+typedef struct
+{
+    AttackMap opponentAttacks; // Squares attacked by the opponent of the player to move.
+    // Plies since the last null move on the current line; set by the parent. Positions before a null move must not
+    // count as repetitions, and the null move does not reset the halfmove counter.
+    int32_t pliesFromNull;
+#if SEARCH_TRACE
+    EncodedMove traceMove; // Move which led to the node, and how the parent searched it.
+    uint8_t traceFlags;
+    uint8_t traceReason;   // Why the node returned; set before early returns.
+#endif
+} SearchStackEntry;
+
+static thread_local SearchStackEntry s_searchStack[MAX_LINE_DEPTH * 2]; // Same extra room as s_moveLines, for quiescence search.
+
+static thread_local SearchStats s_searchStats;
 
 static volatile bool s_evalCanceled = false;
 
+// Search trace bookkeeping; see SearchTrace.h. The parent sets the move and flags of a child before searching it, the
+// child sets its reason before returning early, and the Minimax and QuiescenceSearch wrappers write the record.
+static FORCE_INLINE void TraceSetMove(int32_t linePly, EncodedMove move, uint8_t flags)
+{
+#if SEARCH_TRACE
+    s_searchStack[linePly].traceMove = move;
+    s_searchStack[linePly].traceFlags = flags;
+#else
+    (void)linePly; (void)move; (void)flags;
+#endif
+}
+
+static FORCE_INLINE void TraceSetReason(int32_t linePly, TraceReason reason)
+{
+#if SEARCH_TRACE
+    s_searchStack[linePly].traceReason = (uint8_t)reason;
+#else
+    (void)linePly; (void)reason;
+#endif
+}
+
+#if SEARCH_TRACE
+static FORCE_INLINE void TraceWrite(const Board * board, int32_t linePly, int32_t depth, int32_t alpha, int32_t beta, int32_t score, SearchNodeType nodeType)
+{
+    const SearchStackEntry * stack = &s_searchStack[linePly];
+    TraceRecord record = { 0 };
+    record.hash = board->hash;
+    record.alpha = alpha;
+    record.beta = beta;
+    record.score = score;
+    record.move = stack->traceMove;
+    record.ply = (uint8_t)linePly;
+    record.depth = (int8_t)max(min(depth, INT8_MAX), INT8_MIN);
+    record.nodeType = (uint8_t)nodeType;
+    record.reason = stack->traceReason;
+    record.flags = stack->traceFlags;
+    SearchTraceWrite(&record);
+}
+#endif
+
 static inline void PrintMoveLine(const MoveLine * line)
 {
     char moveStr[6]; // Max 5 chars plus extra character for null-termination
@@ -132,50 +176,140 @@ static inline int32_t ValueFromTranspositionTable(int32_t eval, int32_t ply)
         return eval;
 }
 
-static inline Move UnpackCachedMove(const Board * board, EncodedMove cachedMove)
+// All transposition table accesses of the search go through these two, so that with TT_STATS the shadow key always
+// belongs to the position being looked up or stored.
+static FORCE_INLINE void SetTTShadowKey(const Board * board)
 {
-    Move m = MoveDecode(cachedMove);
-    EncodedSquare from = SquareEncode(m.from);
-    const uint64_t * pieceTables = (board->playerToMove == White) ? board->whitePieceTables : board->blackPieceTables;
-    if (pieceTables[PIECE_TABLE_PAWNS] & from)
-        m.piece = Pawn;
-    else if (pieceTables[PIECE_TABLE_KNIGHTS] & from)
-        m.piece = Knight;
-    else if (pieceTables[PIECE_TABLE_BISHOPS_QUEENS] & from)
+#if TT_STATS
+    // Any function of the position works, as long as it does not depend on the Zobrist keys.
+    uint64_t key = (uint64_t)board->castleBits | ((uint64_t)board->enPassantSquare << 8) | ((uint64_t)board->playerToMove << 16);
+    for (Player player = White; player <= Black; ++player)
     {
-        if (pieceTables[PIECE_TABLE_ROOKS_QUEENS] & from)
-            m.piece = Queen;
-        else
-            m.piece = Bishop;
+        for (int table = 0; table < NUM_PIECE_TABLES; ++table)
+        {
+            key = (key ^ BoardGetPlayerPieceTable(board, player, table)) * 0x9E3779B97F4A7C15ull;
+            key ^= key >> 29;
+        }
     }
-    else if (pieceTables[PIECE_TABLE_ROOKS_QUEENS] & from)
-        m.piece = Rook;
-    else
-        m.piece = King;
+    TranspositionTableSetShadowKey(&s_transpositionTable, key);
+#else
+    (void)board;
+#endif
+}
+
+static FORCE_INLINE TranspositionType LookupTT(const Board * board, EncodedMove * move, int32_t * eval, int32_t * depth)
+{
+    SetTTShadowKey(board);
+    PROFILE_BEGIN(ProfileZoneTranspositionTable);
+    TranspositionType type = TranspositionTableLookup(&s_transpositionTable, board->hash, move, eval, depth);
+    PROFILE_END(ProfileZoneTranspositionTable);
+    return type;
+}
+
+static FORCE_INLINE void InsertTT(const Board * board, EncodedMove move, int32_t eval, int32_t depth, TranspositionType type)
+{
+    SetTTShadowKey(board);
+    PROFILE_BEGIN(ProfileZoneTranspositionTable);
+    TranspositionTableInsert(&s_transpositionTable, board->hash, move, eval, depth, type);
+    PROFILE_END(ProfileZoneTranspositionTable);
+}
+
+// Most of the work of move ordering happens lazily, as the moves are picked.
+static FORCE_INLINE bool GetNextMove(MoveOrderer * moveOrderer, Move * move)
+{
+    PROFILE_BEGIN(ProfileZoneMoveOrdering);
+    bool hasMove = MoveOrdererGetNextMove(moveOrderer, move);
+    PROFILE_END(ProfileZoneMoveOrdering);
+    return hasMove;
+}
+
+// Kind of move for the move ordering statistics (SEARCH_MOVE_ flags); nothing is computed unless they are enabled.
+static FORCE_INLINE uint8_t SearchStatsMoveKind(Move move, EncodedMove ttMove, const KillerMoves * killerMoves, bool isCapture)
+{
+#if SEARCH_STATS
+    uint8_t kind = 0;
+    if (EncodedMoveValid(ttMove) && MoveEncode(move) == ttMove)
+        kind |= SEARCH_MOVE_HASH;
+    if (killerMoves != NULL && KillerMoveFind(killerMoves, move))
+        kind |= SEARCH_MOVE_KILLER;
+    if (isCapture)
+        kind |= SEARCH_MOVE_CAPTURE;
+    return kind;
+#else
+    (void)move; (void)ttMove; (void)killerMoves; (void)isCapture;
+    return 0;
+#endif
+}
+
+static inline Move UnpackCachedMove(const Board * board, EncodedMove cachedMove)
+{
+    Move m = MoveDecode(cachedMove);
+    m.piece = BoardGetPieceAtSquare(board, m.from);
     return m;
 }
 
 // Quiescence or "quiet" search. Basically, continue searching through capture chains until we reach
 // a "quiet" position where there are no winning tactical moves; i.e. captures.
-static int32_t QuiescenceSearch(const Board * board, int32_t depth, int32_t alpha, int32_t beta, int32_t linePly, const MoveLine * bestLinePrev, MoveLine * bestLine, int moveCounter, bool pv)
+static int32_t QuiescenceSearchNode(const Board * board, int32_t depth, int32_t alpha, int32_t beta, int32_t linePly, const MoveLine * bestLinePrev, MoveLine * bestLine, int moveCounter, bool pv);
+
+static FORCE_INLINE int32_t QuiescenceSearch(const Board * board, int32_t depth, int32_t alpha, int32_t beta, int32_t linePly, const MoveLine * bestLinePrev, MoveLine * bestLine, int moveCounter, bool pv)
+{
+#if SEARCH_TRACE
+    TraceSetReason(linePly, TraceReasonSearched);
+    int32_t score = QuiescenceSearchNode(board, depth, alpha, beta, linePly, bestLinePrev, bestLine, moveCounter, pv);
+    TraceWrite(board, linePly, depth, alpha, beta, score, SearchNodeQuiescence);
+    return score;
+#else
+    return QuiescenceSearchNode(board, depth, alpha, beta, linePly, bestLinePrev, bestLine, moveCounter, pv);
+#endif
+}
+
+// Score of a position which has been repeated, from the point of view of the player to move in that position.
+static FORCE_INLINE int32_t RepetitionScore(const Board * board, int numPiecesRemaining)
+{
+    // Contempt: encourage playing for a win when in the early and mid games. As the game progresses, the chance of a draw increases.
+    // In a king and pawn endgame, always use a true draw value to prevent blundering.
+    if (numPiecesRemaining <= 2 + intrinsic_popcnt64(BoardGetPlayerPieceTable(board, White, PIECE_TABLE_PAWNS)) + intrinsic_popcnt64(BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_PAWNS)))
+        return 0;
+
+    int contempt = numPiecesRemaining * 10;
+    return -contempt;
+}
+
+static int32_t QuiescenceSearchNode(const Board * board, int32_t depth, int32_t alpha, int32_t beta, int32_t linePly, const MoveLine * bestLinePrev, MoveLine * bestLine, int moveCounter, bool pv)
 {
     if (s_evalCanceled && linePly > 0)
+    {
+        TraceSetReason(linePly, TraceReasonAborted);
         return 0;
+    }
 
-    // TODO: Repetition check is not needed in quiescence search since we only check for captures and not checks,
-    // but if we also test for checks, then it may be useful/necessary to include repetition checks here too.
+    SearchStatsNode(&s_searchStats, SearchNodeQuiescence, 0);
+
+    // Evasions are not necessarily captures, so a line of checks and evasions can go on indefinitely. Stop before it
+    // runs out of the per ply arrays.
+    if (linePly >= MAX_LINE_DEPTH * 2 - 1)
+    {
+        PROFILE_BEGIN(ProfileZoneEvaluation);
+        int32_t staticEval = Evaluate(board);
+        PROFILE_END(ProfileZoneEvaluation);
+        return (board->playerToMove == Black) ? -staticEval : staticEval;
+    }
 
     EncodedMove ttMove = 0;
 #if ENABLE_TT
     // TODO: Probably don't need to check TT when depth == 0 because the same check should have happened in regular search.
     int32_t ttEval = 0;
     int32_t ttDepth = 0;
-    TranspositionType ttTypeCached = TranspositionTableLookup(&s_transpositionTable, board->hash, &ttMove, &ttEval, &ttDepth);
+    TranspositionType ttTypeCached = LookupTT(board, &ttMove, &ttEval, &ttDepth);
+    s_ttProbes++;
+    s_ttProbeHits += (ttTypeCached != TranspositionNone);
     if (ttTypeCached != TranspositionNone && ttDepth >= (depth - (ttTypeCached == TranspositionExact)))
     {
         if (((ttTypeCached & TranspositionBeta) && ttEval >= beta) || ((ttTypeCached & TranspositionAlpha) && ttEval <= alpha))
         {
-            s_ttHits++;
+            SearchStatsEvent(&s_searchStats, SearchEventTTCutoff);
+            TranspositionTableStatsCutoff(&s_transpositionTable);
 
             // Only include move if the depth is zero (first q-search). Otherwise, we might add in a wrong move at the very end of the line,
             // with other q-search moves (absent in the saved line) in between this move and moves from the regular search.
@@ -186,51 +320,87 @@ static int32_t QuiescenceSearch(const Board * board, int32_t depth, int32_t alph
                 //bestLine->moves[0] = UnpackCachedMove(board, ttMove);
                 //bestLine->length = 1;
             }
+            TraceSetReason(linePly, TraceReasonTTCutoff);
             return ValueFromTranspositionTable(ttEval, linePly);
         }
     }
 #endif
 
+    PROFILE_BEGIN(ProfileZoneEvaluation);
     int32_t staticEval = Evaluate(board); // (board->playerToMove == White) ? board->staticEval : -board->staticEval; // Evaluate(board);
+    PROFILE_END(ProfileZoneEvaluation);
     //assert(staticEval == board->staticEval); // TODO: Eventually transition this over.
 
     if (board->playerToMove == Black)
         staticEval = -staticEval;
 
-    if (staticEval >= beta)
+    CheckInfo checkInfo;
+    PROFILE_BEGIN(ProfileZoneMoveGeneration);
+    CheckInfoInitialize(&checkInfo, board);
+    PROFILE_END(ProfileZoneMoveGeneration);
+    bool inCheck = checkInfo.checkers != 0;
+
+    // Only evasions can be quiet moves, so only a position in check can repeat one seen earlier in the search.
+    if (inCheck && linePly > 0 && RepetitionStackContains(&s_repetitionStack, linePly, board->hash, board->halfmoveCounter, s_searchStack[linePly].pliesFromNull))
+    {
+        SearchStatsEvent(&s_searchStats, SearchEventRepetition);
+        TraceSetReason(linePly, TraceReasonRepetition);
+        return RepetitionScore(board, (int)intrinsic_popcnt64(BoardGetOccupancy(board)));
+    }
+    RepetitionStackStore(&s_repetitionStack, linePly, board->hash);
+
+    // Standing pat is not an option when in check; every evasion needs to be searched instead.
+    if (!inCheck)
     {
+        if (staticEval >= beta)
+        {
 #if ENABLE_TT
-        if (linePly > 0)
-            TranspositionTableInsert(&s_transpositionTable, board->hash, (EncodedMove)0, ValueToTranspositionTable(staticEval, linePly), depth, TranspositionBeta);
+            if (linePly > 0)
+                InsertTT(board, (EncodedMove)0, ValueToTranspositionTable(staticEval, linePly), depth, TranspositionBeta);
 #endif
-        return staticEval; // TODO: Maybe return staticEval?
+            TraceSetReason(linePly, TraceReasonStandPat);
+            return staticEval; // TODO: Maybe return staticEval?
+        }
+        else if (staticEval > alpha)
+            alpha = staticEval;
     }
-    else if (staticEval > alpha)
-        alpha = staticEval;
 
-    Move * moves = &s_moves[moveCounter];
+    Move * moves = s_generatedMoves;
     MoveLine * line = &s_moveLines[linePly];
     MoveLineInit(line);
     Board nextBoard;
 #if EVAL_PSEUDO_LEGAL
     bool hasValidMove = false;
-    uint8_t numMoves = GetPseudoLegalCaptures(board, moves);
+    PROFILE_BEGIN(ProfileZoneMoveGeneration);
+    uint8_t numMoves = inCheck ? GetEvasions(board, moves) : GetPseudoLegalCaptures(board, moves);
+    PROFILE_END(ProfileZoneMoveGeneration);
 #else
-    uint8_t numMoves = GetValidCaptures(board, moves);
+    PROFILE_BEGIN(ProfileZoneMoveGeneration);
+    uint8_t numMoves = inCheck ? GetEvasions(board, moves) : GetValidCaptures(board, moves);
+    PROFILE_END(ProfileZoneMoveGeneration);
 
-    // At the end of quiescence search, do a full search one last time to see if checkmate happened.
     if (numMoves == 0)
     {
-        if (IsCheckmate(board, playerToMove))
+        if (inCheck)
+        {
+            TraceSetReason(linePly, TraceReasonNoMoves);
             return CHECKMATE_LOSE + linePly;
+        }
         // No valid moves and not in check; must be a quiet position.
         return alpha;
     }
 #endif
     MoveOrderer moveOrderer;
 
+    SearchStackEntry * stack = &s_searchStack[linePly];
+    PROFILE_BEGIN(ProfileZoneMoveGeneration);
+    AttackMapInitialize(&stack->opponentAttacks, board, !board->playerToMove);
+    PROFILE_END(ProfileZoneMoveGeneration);
+
     // Order moves via heuristic to improve performance of alpha-beta pruning.
-    MoveOrdererInitialize(&moveOrderer, board, moves, &s_approxMoveScores[moveCounter], numMoves, linePly, bestLinePrev, &s_killerMoves[linePly], MoveDecode(ttMove));
+    PROFILE_BEGIN(ProfileZoneMoveOrdering);
+    MoveOrdererInitialize(&moveOrderer, board, moves, &s_moveKeys[moveCounter], numMoves, &stack->opponentAttacks, linePly, bestLinePrev, &s_killerMoves[linePly], MoveDecode(ttMove));
+    PROFILE_END(ProfileZoneMoveOrdering);
 
     // Initialize null move. If no move is found within the alpha-beta cutoff, then this null move is
     // inserted into the transposition table; we haven't identified what the best move is due to cutoff,
@@ -241,7 +411,7 @@ static int32_t QuiescenceSearch(const Board * board, int32_t depth, int32_t alph
     bestMove.piece = 0;
     bestMove.promotion = 0;
 
-    unsigned long long pieceCount = intrinsic_popcnt64(board->allPieceTables);
+    unsigned long long pieceCount = intrinsic_popcnt64(BoardGetOccupancy(board));
     if (pieceCount > 23)
         pieceCount = 23;
     float midGameProgressionScalar = MidGameScalar[pieceCount];
@@ -249,12 +419,12 @@ static int32_t QuiescenceSearch(const Board * board, int32_t depth, int32_t alph
     PieceType capturedPiece;
 
     Move move;
-    uint64_t cntt = 0;
-    while (MoveOrdererGetNextMove(&moveOrderer, &move))
+    int i = 0;
+    while (GetNextMove(&moveOrderer, &move))
     {
-        cntt++;
 #if EVAL_PSEUDO_LEGAL
-        if (!IsMoveValid(board, move))
+        // Evasions are always legal.
+        if (!inCheck && !IsMoveLegal(board, &checkInfo, move))
             continue;
 
         hasValidMove = true;
@@ -262,62 +432,73 @@ static int32_t QuiescenceSearch(const Board * board, int32_t depth, int32_t alph
 
 #if 1
         // Delta pruning: if the capture can't raise the score by enough, then don't bother continuining further.
-        // Also called q-search futility pruning.
-        capturedPiece = BoardGetPieceAtSquare(board, move.to);
-        if (capturedPiece == None)
+        // Also called q-search futility pruning. Evasions are not necessarily captures, so never prune them.
+        if (!inCheck)
         {
-            // Special case; this must be en-passant.
-            if (GetPieceValue(midGameProgressionScalar, endGameProgressionScalar, !board->playerToMove, Pawn, board->playerToMove == White ? SquareMoveRankDown(move.to) : SquareMoveRankUp(move.to)) + 2000 <= alpha)
-                continue;
-        }
-        else
-        {
-            if (GetPieceValue(midGameProgressionScalar, endGameProgressionScalar, !board->playerToMove, Pawn, move.to) + 2000 <= alpha)
-                continue;
+            capturedPiece = BoardGetPieceAtSquare(board, move.to);
+            if (capturedPiece == None)
+            {
+                // Special case; this must be en-passant.
+                if (GetPieceValue(midGameProgressionScalar, endGameProgressionScalar, !board->playerToMove, Pawn, board->playerToMove == White ? SquareMoveRankDown(move.to) : SquareMoveRankUp(move.to)) + 2000 <= alpha)
+                    continue;
+            }
+            else
+            {
+                if (GetPieceValue(midGameProgressionScalar, endGameProgressionScalar, !board->playerToMove, Pawn, move.to) + 2000 <= alpha)
+                    continue;
+            }
         }
 #endif
 
-        nextBoard = *board;
         s_positionsEvaluated++;
+        PROFILE_BEGIN(ProfileZoneMakeMove);
+        nextBoard = *board;
         MakeMove(&nextBoard, move);
+        PROFILE_END(ProfileZoneMakeMove);
+        s_searchStack[linePly + 1].pliesFromNull = s_searchStack[linePly].pliesFromNull + 1;
+        uint8_t moveKind = SearchStatsMoveKind(move, ttMove, NULL, intrinsic_popcnt64(BoardGetOccupancy(board)) > intrinsic_popcnt64(BoardGetOccupancy(&nextBoard)));
+        SearchStatsMove(&s_searchStats, SearchNodeQuiescence, 0, moveKind);
 
         // TODO: (12/30/2024) Validate this actually does what is expected. Intention is to prune additional moves.
-        //bool givesCheck = KingIsAttacked(&nextBoard, nextBoard.playerToMove);
+        //bool givesCheck = MoveGivesCheck(board, &checkInfo, move);
         //if (move.promotion != None && !givesCheck && alpha > -EVAL_CHECKMATE && moveCounter > 2)
         //    continue;
 
+        TraceSetMove(linePly + 1, MoveEncode(move), 0);
         int32_t score = -QuiescenceSearch(&nextBoard, depth - 1, -beta, -alpha, linePly + 1, bestLinePrev, line, moveCounter + numMoves, pv);
         if (score >= beta)
         {
 #if ENABLE_TT
             if (linePly > 0)
-                TranspositionTableInsert(&s_transpositionTable, board->hash, MoveEncode(move), ValueToTranspositionTable(score, linePly), depth, TranspositionBeta);
+                InsertTT(board, MoveEncode(move), ValueToTranspositionTable(score, linePly), depth, TranspositionBeta);
 #endif
-            bestLine->moves[0] = move;
-            memcpy(bestLine->moves + 1, line->moves, line->length * sizeof(Move));
-            bestLine->length = line->length + 1;
+            SearchStatsCutoff(&s_searchStats, SearchNodeQuiescence, 0, i, moveKind);
+            TraceSetReason(linePly, TraceReasonBetaCutoff);
+            MoveLinePrepend(bestLine, move, line);
             return score; // TODO: Maybe return score?
         }
         if (score > alpha)
         {
+            SearchStatsAlphaUpdate(&s_searchStats, SearchNodeQuiescence, 0);
             alpha = score;
             bestMove = move;
-            bestLine->moves[0] = bestMove;
-            memcpy(bestLine->moves + 1, line->moves, line->length * sizeof(Move));
-            bestLine->length = line->length + 1;
+            MoveLinePrepend(bestLine, bestMove, line);
         }
+
+        i++;
     }
-    //s_avgMoveOrderer += cntt;
-    //s_avgMoveOrdererCnt++;
 
 #if EVAL_PSEUDO_LEGAL
     if (!hasValidMove)
     {
-        // TODO: Try to devise a better way to handle this. This is rather expensive at the end of q-search.
-        if (IsCheckmate(board))
+        // No evasions: checkmate.
+        if (inCheck)
+        {
+            TraceSetReason(linePly, TraceReasonNoMoves);
             return CHECKMATE_LOSE + linePly;
+        }
 
-        // No valid moves and not in check; must be a quiet position.
+        // No valid captures and not in check; must be a quiet position.
         return alpha;
     }
 #endif
@@ -325,52 +506,119 @@ static int32_t QuiescenceSearch(const Board * board, int32_t depth, int32_t alph
 #if ENABLE_TT
     // No point in saving the root node to the transposition table. Also would give extremely abbreviated results on subsequent searches.
     if (linePly > 0)
-        TranspositionTableInsert(&s_transpositionTable, board->hash, MoveEncode(bestMove), ValueToTranspositionTable(alpha, linePly), depth, TranspositionAlpha);
+        InsertTT(board, MoveEncode(bestMove), ValueToTranspositionTable(alpha, linePly), depth, TranspositionAlpha);
 #endif
     return alpha;
 }
 
-static int32_t Minimax(const Board * board, int32_t alpha, int32_t beta, int32_t depth, int32_t linePly, const MoveLine * bestLinePrev, MoveLine * bestLine, int32_t totalExtension, int moveCounter, bool pv)
+// Checks whether the player to move has a reversible move which returns to a position already seen, either earlier
+// in the search or in the game history. Each earlier position with the other player to move is XORed with the current
+// hash; if the difference is the hash of a single reversible move (found in the cuckoo tables) and nothing blocks
+// that move, then a repetition can be reached in one move. Positions before the last null move are not compared.
+static bool HasUpcomingRepetition(const Board * board, int32_t linePly)
+{
+    size_t top = s_repetitionStack.length + linePly;
+    size_t distance = (board->halfmoveCounter < top) ? board->halfmoveCounter : top;
+    if ((size_t)s_searchStack[linePly].pliesFromNull < distance)
+        distance = (size_t)s_searchStack[linePly].pliesFromNull;
+    for (size_t i = 3; i <= distance; i += 2)
+    {
+        Square a;
+        Square b;
+        if (!CuckooLookup(board->hash ^ s_repetitionStack.hashes[top - i], &a, &b))
+            continue;
+        if (s_inBetweenMask[a][b] & BoardGetOccupancy(board))
+            continue;
+
+        // Within the search, either player may be the one to return to the earlier position.
+        if (i < (size_t)linePly)
+            return true;
+
+        // For positions at or before the root, the move must belong to the player to move; otherwise the
+        // difference in hash is the opponent's last move, not a move which can be made now.
+        EncodedSquare friendlyPieces = BoardGetPlayerPieceTable(board, board->playerToMove, PIECE_TABLE_COMBINED);
+        if (friendlyPieces & (SquareEncode(a) | SquareEncode(b)))
+            return true;
+    }
+    return false;
+}
+
+static int32_t MinimaxNode(const Board * board, int32_t alpha, int32_t beta, int32_t depth, int32_t linePly, const MoveLine * bestLinePrev, MoveLine * bestLine, int32_t totalExtension, int moveCounter, bool pv);
+
+static FORCE_INLINE int32_t Minimax(const Board * board, int32_t alpha, int32_t beta, int32_t depth, int32_t linePly, const MoveLine * bestLinePrev, MoveLine * bestLine, int32_t totalExtension, int moveCounter, bool pv)
+{
+#if SEARCH_TRACE
+    TraceSetReason(linePly, TraceReasonSearched);
+    int32_t score = MinimaxNode(board, alpha, beta, depth, linePly, bestLinePrev, bestLine, totalExtension, moveCounter, pv);
+    TraceWrite(board, linePly, depth, alpha, beta, score, (depth <= 0) ? SearchNodeQuiescence : (pv ? SearchNodePV : SearchNodeNonPV));
+    return score;
+#else
+    return MinimaxNode(board, alpha, beta, depth, linePly, bestLinePrev, bestLine, totalExtension, moveCounter, pv);
+#endif
+}
+
+static int32_t MinimaxNode(const Board * board, int32_t alpha, int32_t beta, int32_t depth, int32_t linePly, const MoveLine * bestLinePrev, MoveLine * bestLine, int32_t totalExtension, int moveCounter, bool pv)
 {
     if (s_evalCanceled && linePly > 0)
+    {
+        TraceSetReason(linePly, TraceReasonAborted);
         return 0;
+    }
 
     if (board->halfmoveCounter >= 100)
     {
         // Draw by 50 move rule.
+        TraceSetReason(linePly, TraceReasonDraw);
         return 0;
     }
 
-    int numPiecesRemaining = (int)intrinsic_popcnt64(board->allPieceTables);
+    int numPiecesRemaining = (int)intrinsic_popcnt64(BoardGetOccupancy(board));
     if (numPiecesRemaining <= 2)
     {
         // Only pieces remaining are Kings; this is a draw.
+        TraceSetReason(linePly, TraceReasonDraw);
         return 0;
     }
     else if (numPiecesRemaining == 3 &&
-             (intrinsic_popcnt64(board->whitePieceTables[PIECE_TABLE_KNIGHTS]) == 1 ||
-              intrinsic_popcnt64(board->blackPieceTables[PIECE_TABLE_KNIGHTS]) == 1 ||
-              intrinsic_andn64(intrinsic_popcnt64(board->whitePieceTables[PIECE_TABLE_ROOKS_QUEENS]), intrinsic_popcnt64(board->whitePieceTables[PIECE_TABLE_BISHOPS_QUEENS])) == 1 ||
-              intrinsic_andn64(intrinsic_popcnt64(board->blackPieceTables[PIECE_TABLE_ROOKS_QUEENS]), intrinsic_popcnt64(board->blackPieceTables[PIECE_TABLE_BISHOPS_QUEENS])) == 1))
+             (intrinsic_popcnt64(BoardGetPlayerPieceTable(board, White, PIECE_TABLE_KNIGHTS)) == 1 ||
+              intrinsic_popcnt64(BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_KNIGHTS)) == 1 ||
+              intrinsic_andn64(intrinsic_popcnt64(BoardGetPlayerPieceTable(board, White, PIECE_TABLE_ROOKS_QUEENS)), intrinsic_popcnt64(BoardGetPlayerPieceTable(board, White, PIECE_TABLE_BISHOPS_QUEENS))) == 1 ||
+              intrinsic_andn64(intrinsic_popcnt64(BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_ROOKS_QUEENS)), intrinsic_popcnt64(BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_BISHOPS_QUEENS))) == 1))
     {
         // Only pieces remaining are two Kings and one bishop or knight (for one player). This is a draw due to lack of sufficient checkmating material.
+        TraceSetReason(linePly, TraceReasonDraw);
         return 0;
     }
 
-    if (RepetitionTableContains(&s_repetitionTable, board->hash))
+    if (linePly > 0 && RepetitionStackContains(&s_repetitionStack, linePly, board->hash, board->halfmoveCounter, s_searchStack[linePly].pliesFromNull))
     {
         // Draw by repetition. Or at least, we repeated a position once already, which means that no improvement was made
         // to the position, which implies an eventual draw.
-        s_repetitions++;
-        // Contempt: encourage playing for a win when in the early and mid games. As the game progresses, the chance of a draw increases.
-        // In a king and pawn endgame, always use a true draw value to prevent blundering.
-        if (numPiecesRemaining <= 2 + intrinsic_popcnt64(board->whitePieceTables[PIECE_TABLE_PAWNS]) + intrinsic_popcnt64(board->blackPieceTables[PIECE_TABLE_PAWNS]))
-            return 0;
+        SearchStatsEvent(&s_searchStats, SearchEventRepetition);
+        TraceSetReason(linePly, TraceReasonRepetition);
+        return RepetitionScore(board, numPiecesRemaining);
+    }
 
-        int contempt = numPiecesRemaining * 10;
-        return -contempt;
+    if (linePly > 0)
+    {
+        // If a repetition can be reached in one move, this node is worth at least the repetition score
+        // (negated, as the repeated position has the opponent to move). Raise alpha early, which can
+        // cut the whole subtree when shuffling pieces around.
+        int32_t repetitionBound = -RepetitionScore(board, numPiecesRemaining);
+        if (alpha < repetitionBound && HasUpcomingRepetition(board, linePly))
+        {
+            SearchStatsEvent(&s_searchStats, SearchEventUpcomingRepetition);
+            alpha = repetitionBound;
+            if (alpha >= beta)
+            {
+                TraceSetReason(linePly, TraceReasonRepetition);
+                return alpha;
+            }
+        }
     }
 
+    RepetitionStackStore(&s_repetitionStack, linePly, board->hash);
+
     if (linePly > s_selDepth)
         s_selDepth = linePly;
 
@@ -390,7 +638,9 @@ static int32_t Minimax(const Board * board, int32_t alpha, int32_t beta, int32_t
 #if 1
 #if ENABLE_TT
         int32_t ttEval = 0;
-        ttTypeCached = TranspositionTableLookup(&s_transpositionTable, board->hash, &ttMove, &ttEval, &ttDepth);
+        ttTypeCached = LookupTT(board, &ttMove, &ttEval, &ttDepth);
+        s_ttProbes++;
+        s_ttProbeHits += (ttTypeCached != TranspositionNone);
 
         if (linePly > 0)
         {
@@ -407,7 +657,8 @@ static int32_t Minimax(const Board * board, int32_t alpha, int32_t beta, int32_t
         {
             if (ttTypeCached & ((ttEval >= beta) ? TranspositionBeta : TranspositionAlpha))
             {
-                s_ttHits++;
+                SearchStatsEvent(&s_searchStats, SearchEventTTCutoff);
+                TranspositionTableStatsCutoff(&s_transpositionTable);
 
                 if (EncodedMoveValid(ttMove))
                 {
@@ -416,6 +667,7 @@ static int32_t Minimax(const Board * board, int32_t alpha, int32_t beta, int32_t
                     //bestLine->moves[0] = UnpackCachedMove(board, ttMove);
                     //bestLine->length = 1;
                 }
+                TraceSetReason(linePly, TraceReasonTTCutoff);
                 return ValueFromTranspositionTable(ttEval, linePly);
             }
         }
@@ -427,10 +679,12 @@ static int32_t Minimax(const Board * board, int32_t alpha, int32_t beta, int32_t
 #if ENABLE_SYZYGY
     if (linePly > 0 && MaxCardinality > 0)
     {
-        if (intrinsic_popcnt64(board->allPieceTables) <= MaxCardinality && board->castleBits == 0 && board->halfmoveCounter == 0)
+        if (intrinsic_popcnt64(BoardGetOccupancy(board)) <= MaxCardinality && board->castleBits == 0 && board->halfmoveCounter == 0)
         {
             ProbeState probeResult;
+            PROFILE_BEGIN(ProfileZoneSyzygy);
             WDLScore wdlScore = SyzygyProbeWDL(board, &probeResult);
+            PROFILE_END(ProfileZoneSyzygy);
             if (probeResult != PROBE_STATE_FAIL)
             {
                 s_tbHits++;
@@ -441,7 +695,8 @@ static int32_t Minimax(const Board * board, int32_t alpha, int32_t beta, int32_t
                     value = -EVAL_CHECKMATE + linePly + 1;
                     if (value <= alpha)
                     {
-                        TranspositionTableInsert(&s_transpositionTable, board->hash, (EncodedMove) 0, ValueToTranspositionTable(value, linePly), depth, TranspositionAlpha);
+                        InsertTT(board, (EncodedMove) 0, ValueToTranspositionTable(value, linePly), depth, TranspositionAlpha);
+                        TraceSetReason(linePly, TraceReasonTablebase);
                         return value;
                     }
                 }
@@ -450,14 +705,16 @@ static int32_t Minimax(const Board * board, int32_t alpha, int32_t beta, int32_t
                     value = EVAL_CHECKMATE - linePly - 1;
                     if (value >= beta)
                     {
-                        TranspositionTableInsert(&s_transpositionTable, board->hash, (EncodedMove) 0, ValueToTranspositionTable(value, linePly), depth, TranspositionBeta);
+                        InsertTT(board, (EncodedMove) 0, ValueToTranspositionTable(value, linePly), depth, TranspositionBeta);
+                        TraceSetReason(linePly, TraceReasonTablebase);
                         return value;
                     }
                 }
                 else
                 {
                     value = 2 * wdlScore;
-                    TranspositionTableInsert(&s_transpositionTable, board->hash, (EncodedMove) 0, ValueToTranspositionTable(value, linePly), depth, TranspositionExact);
+                    InsertTT(board, (EncodedMove) 0, ValueToTranspositionTable(value, linePly), depth, TranspositionExact);
+                    TraceSetReason(linePly, TraceReasonTablebase);
                     return value;
                 }
             }
@@ -468,7 +725,8 @@ static int32_t Minimax(const Board * board, int32_t alpha, int32_t beta, int32_t
     if (depth <= 0)
     {
 #if 1
-        return QuiescenceSearch(board, depth, alpha, beta, linePly, bestLinePrev, bestLine, moveCounter, pv);
+        // Call the node directly, so the trace has a single record for this node.
+        return QuiescenceSearchNode(board, depth, alpha, beta, linePly, bestLinePrev, bestLine, moveCounter, pv);
 #else
         int32_t staticEval = Evaluate(board);
         if (board->playerToMove == Black)
@@ -477,14 +735,25 @@ static int32_t Minimax(const Board * board, int32_t alpha, int32_t beta, int32_t
 #endif
     }
 
-    Move * moves = &s_moves[moveCounter];
+    // Statistics are kept under the depth the node was entered with, even if the depth is reduced below.
+    SearchNodeType nodeType = pv ? SearchNodePV : SearchNodeNonPV;
+    int32_t nodeDepth = depth;
+    SearchStatsNode(&s_searchStats, nodeType, nodeDepth);
+
+    Move * moves = s_generatedMoves;
     MoveLine * line = &s_moveLines[linePly];
     MoveLineInit(line);
     Board nextBoard;
 
-    bool inCheck = KingIsAttacked(board, board->playerToMove);
+    CheckInfo checkInfo;
+    PROFILE_BEGIN(ProfileZoneMoveGeneration);
+    CheckInfoInitialize(&checkInfo, board);
+    PROFILE_END(ProfileZoneMoveGeneration);
+    bool inCheck = checkInfo.checkers != 0;
 
+    PROFILE_BEGIN(ProfileZoneEvaluation);
     int32_t staticEval = Evaluate(board); // (board->playerToMove == White) ? board->staticEval : -board->staticEval; // Evaluate(board);
+    PROFILE_END(ProfileZoneEvaluation);
     //assert(staticEval == board->staticEval); // TODO: Eventually transition this over.
     //int staticEval = (board->playerToMove == White) ? board->staticEval : -board->staticEval; // Evaluate(board);
 
@@ -501,9 +770,15 @@ static int32_t Minimax(const Board * board, int32_t alpha, int32_t beta, int32_t
             staticEval < EVAL_CHECKMATE)
             return staticEval;*/
         if (depth < 9 && staticEval + 900 * depth + 1250 <= alpha && staticEval < EVAL_CHECKMATE && staticEval > -EVAL_CHECKMATE)
+        {
+            TraceSetReason(linePly, TraceReasonFutility);
             return staticEval;
+        }
         if (depth < 9 && staticEval - (depth * 1400) >= beta && staticEval < EVAL_CHECKMATE && staticEval > -EVAL_CHECKMATE)
+        {
+            TraceSetReason(linePly, TraceReasonReverseFutility);
             return staticEval;
+        }
 #endif
 
 #if 1
@@ -521,13 +796,18 @@ static int32_t Minimax(const Board * board, int32_t alpha, int32_t beta, int32_t
         if (numPiecesRemaining >= 4 && depth >= R)
         {
             // Attempt to make a null move (null move forward pruning).
+            PROFILE_BEGIN(ProfileZoneMakeMove);
             nextBoard = *board;
             MakeNullMove(&nextBoard);
+            PROFILE_END(ProfileZoneMakeMove);
+            s_searchStack[linePly + 1].pliesFromNull = 0;
 
+            TraceSetMove(linePly + 1, 0, TRACE_FLAG_NULL_MOVE | TRACE_FLAG_ZERO_WINDOW);
             int32_t score = -Minimax(&nextBoard, -beta, -beta + 1, depth - R, linePly + 1, NULL, line, totalExtension, moveCounter, false);
             if (score >= beta)
             {
-                s_nullMovePruning++;
+                SearchStatsEvent(&s_searchStats, SearchEventNullMoveCutoff);
+                TraceSetReason(linePly, TraceReasonNullMove);
                 return beta;
             }
         }
@@ -541,9 +821,13 @@ static int32_t Minimax(const Board * board, int32_t alpha, int32_t beta, int32_t
 
 #if EVAL_PSEUDO_LEGAL
     bool hasValidMove = false;
-    uint8_t numMoves = GetPseudoLegalMoves(board, moves);
+    PROFILE_BEGIN(ProfileZoneMoveGeneration);
+    uint8_t numMoves = inCheck ? GetEvasions(board, moves) : GetPseudoLegalMoves(board, moves);
+    PROFILE_END(ProfileZoneMoveGeneration);
 #else
-    uint8_t numMoves = GetValidMoves(board, moves);
+    PROFILE_BEGIN(ProfileZoneMoveGeneration);
+    uint8_t numMoves = inCheck ? GetEvasions(board, moves) : GetValidMoves(board, moves);
+    PROFILE_END(ProfileZoneMoveGeneration);
     if (numMoves == 0) // Checkmate?
     {
         // If king is in check, then game over: checkmate. Otherwise, stalemate.
@@ -559,9 +843,16 @@ static int32_t Minimax(const Board * board, int32_t alpha, int32_t beta, int32_t
 #endif
     MoveOrderer moveOrderer;
 
+    SearchStackEntry * stack = &s_searchStack[linePly];
+    PROFILE_BEGIN(ProfileZoneMoveGeneration);
+    AttackMapInitialize(&stack->opponentAttacks, board, !board->playerToMove);
+    PROFILE_END(ProfileZoneMoveGeneration);
+
     // Order moves via heuristic to improve performance of alpha-beta pruning.
     // TODO: Should probably explicitly discard bestLinePrev when we are no longer looking at the PV.
-    MoveOrdererInitialize(&moveOrderer, board, moves, &s_approxMoveScores[moveCounter], numMoves, linePly, bestLinePrev, &s_killerMoves[linePly], MoveDecode(ttMove));
+    PROFILE_BEGIN(ProfileZoneMoveOrdering);
+    MoveOrdererInitialize(&moveOrderer, board, moves, &s_moveKeys[moveCounter], numMoves, &stack->opponentAttacks, linePly, bestLinePrev, &s_killerMoves[linePly], MoveDecode(ttMove));
+    PROFILE_END(ProfileZoneMoveOrdering);
 
     //if (pv && linePly == 0 && depth <= 1)
     //    MoveOrdererPrint(&moveOrderer);
@@ -576,41 +867,44 @@ static int32_t Minimax(const Board * board, int32_t alpha, int32_t beta, int32_t
     bestMove.piece = 0;
     bestMove.promotion = 0;*/
 
-    RepetitionTablePush(&s_repetitionTable, board->hash);
-
     Move move;
     int i = 0;
-    uint64_t cntt = 0;
     // TODO: (12/30/2024) See if it is possible to implement some kind of hybrid-pseudo-legal move system to eliminate some of the "obvious"
     // impossible moves that would maybe make move ordering faster.
-    while (MoveOrdererGetNextMove(&moveOrderer, &move))
+    while (GetNextMove(&moveOrderer, &move))
     {
-        cntt++;
         if (s_evalCanceled && linePly > 0)
         {
-            RepetitionTablePop(&s_repetitionTable, board->hash);
+            TraceSetReason(linePly, TraceReasonAborted);
             return 0;
         }
 
 #if EVAL_PSEUDO_LEGAL
-        if (!IsMoveValid(board, move))
+        // Evasions are always legal.
+        if (!inCheck && !IsMoveLegal(board, &checkInfo, move))
             continue;
 
         hasValidMove = true;
 #endif
 
-        nextBoard = *board;
+        bool givesCheck = MoveGivesCheck(board, &checkInfo, move);
+
         s_positionsEvaluated++;
+        PROFILE_BEGIN(ProfileZoneMakeMove);
+        nextBoard = *board;
         MakeMove(&nextBoard, move);
+        PROFILE_END(ProfileZoneMakeMove);
+        s_searchStack[linePly + 1].pliesFromNull = s_searchStack[linePly].pliesFromNull + 1;
 
         int32_t score = 0;
         bool fullSearch = true;
 
-        bool isCapture = numPiecesRemaining > intrinsic_popcnt64(nextBoard.allPieceTables);
+        bool isCapture = numPiecesRemaining > intrinsic_popcnt64(BoardGetOccupancy(&nextBoard));
 
-        bool isPromotion = move.promotion != None;
+        uint8_t moveKind = SearchStatsMoveKind(move, ttMove, &s_killerMoves[linePly], isCapture);
+        SearchStatsMove(&s_searchStats, nodeType, nodeDepth, moveKind);
 
-        bool givesCheck = KingIsAttacked(&nextBoard, nextBoard.playerToMove);
+        bool isPromotion = move.promotion != None;
 
         bool lmrPass = false;
 
@@ -638,7 +932,7 @@ static int32_t Minimax(const Board * board, int32_t alpha, int32_t beta, int32_t
                 extension = 2;
 
             if (extension > 0)
-                s_extensions++;
+                SearchStatsEvent(&s_searchStats, SearchEventExtension);
         }
 #endif
         /*if (linePly > 0 && depth < 12 && !inCheck && !isCapture && !isPromotion && staticEval + 900 * depth + 1250 <= alpha && staticEval < EVAL_CHECKMATE && staticEval > -EVAL_CHECKMATE)
@@ -658,11 +952,12 @@ static int32_t Minimax(const Board * board, int32_t alpha, int32_t beta, int32_t
         {
             // TODO: Make this reduction variable. Needs a lot of testing to see.
             MoveLineInit(line);
+            TraceSetMove(linePly + 1, MoveEncode(move), TRACE_FLAG_REDUCED | TRACE_FLAG_ZERO_WINDOW);
             score = -Minimax(&nextBoard, -(alpha + 1), -alpha, depth - 1 - LMR_REDUCTION, linePly + 1, bestLinePrev, line, totalExtension, moveCounter + numMoves, false);
             if (score <= alpha)
             {
                 // Not worth checking; prune.
-                s_lmrPruning++;
+                SearchStatsEvent(&s_searchStats, SearchEventLMRPrune);
                 fullSearch = false;
             }
             else
@@ -684,11 +979,19 @@ static int32_t Minimax(const Board * board, int32_t alpha, int32_t beta, int32_t
         if (fullSearch)
         {
             // If not in the principal variation, do a reduced search first.
+            bool scouted = lmrPass;
             if ((!pv || i > 0) && !lmrPass)
+            {
+                TraceSetMove(linePly + 1, MoveEncode(move), TRACE_FLAG_ZERO_WINDOW);
                 score = -Minimax(&nextBoard, -(alpha + 1), -alpha, depth - 1 + extension, linePly + 1, bestLinePrev, line, totalExtension + extension, moveCounter + numMoves, false);
+                scouted = true;
+            }
             // Do a full search for principal variation or if the reduced search showed something promising.
             if (pv || i == 0 || (score > alpha && beta - alpha > 1))
+            {
+                TraceSetMove(linePly + 1, MoveEncode(move), scouted ? TRACE_FLAG_RESEARCH : 0);
                 score = -Minimax(&nextBoard, -beta, -alpha, depth - 1 + extension, linePly + 1, bestLinePrev, line, totalExtension + extension, moveCounter + numMoves, pv);
+            }
         }
         /*s_foo[linePly] = score;
         printf("Line:");
@@ -709,41 +1012,34 @@ static int32_t Minimax(const Board * board, int32_t alpha, int32_t beta, int32_t
         {
 #if ENABLE_TT
             if (linePly > 0)
-                TranspositionTableInsert(&s_transpositionTable, board->hash, MoveEncode(move), ValueToTranspositionTable(score, linePly), depth, TranspositionBeta);
+                InsertTT(board, MoveEncode(move), ValueToTranspositionTable(score, linePly), depth, TranspositionBeta);
 #endif
-            RepetitionTablePop(&s_repetitionTable, board->hash);
             // Store as a "killer" move so we can do smarter move ordering.
             if (!isCapture)
                 KillerMoveAdd(&s_killerMoves[linePly], move);
-            s_betaCutoffs++;
-            bestLine->moves[0] = move;
-            memcpy(bestLine->moves + 1, line->moves, line->length * sizeof(Move));
-            bestLine->length = line->length + 1;
+            SearchStatsCutoff(&s_searchStats, nodeType, nodeDepth, i, moveKind);
+            TraceSetReason(linePly, TraceReasonBetaCutoff);
+            MoveLinePrepend(bestLine, move, line);
             return score;
         }
         if (score > alpha)
         {
-            s_alphaUpdates++;
+            SearchStatsAlphaUpdate(&s_searchStats, nodeType, nodeDepth);
             alpha = score;
             if (pv)
                 ttType = TranspositionExact;
             bestMove = move;
-            bestLine->moves[0] = bestMove;
-            memcpy(bestLine->moves + 1, line->moves, line->length * sizeof(Move));
-            bestLine->length = line->length + 1;
+            MoveLinePrepend(bestLine, bestMove, line);
         }
 
         i++;
     }
-    s_avgMoveOrderer += cntt;
-    s_avgMoveOrdererCnt++;
 
 #if EVAL_PSEUDO_LEGAL
     if (!hasValidMove)
     {
-        RepetitionTablePop(&s_repetitionTable, board->hash);
-
         // If king is in check, then game over: checkmate. Otherwise, stalemate.
+        TraceSetReason(linePly, TraceReasonNoMoves);
         if (inCheck)
         {
             return CHECKMATE_LOSE + linePly;
@@ -759,20 +1055,19 @@ static int32_t Minimax(const Board * board, int32_t alpha, int32_t beta, int32_t
     // No point in saving the root node to the transposition table. Also would give extremely abbreviated results on subsequent searches.
     // TODO: I suspect TT entries with mate in the eval are incorrect. Need to fix.
     if (linePly > 0)
-        TranspositionTableInsert(&s_transpositionTable, board->hash, MoveEncode(bestMove), ValueToTranspositionTable(alpha, linePly), depth, ttType);
+        InsertTT(board, MoveEncode(bestMove), ValueToTranspositionTable(alpha, linePly), depth, ttType);
 #endif
-    RepetitionTablePop(&s_repetitionTable, board->hash);
 
     return alpha;
 }
 
 static inline bool OnlyOneMove(const Board * board, MoveLine * line)
 {
-    uint8_t numMoves = GetValidMoves(board, s_moves);
+    uint8_t numMoves = GetValidMoves(board, s_generatedMoves);
     if (numMoves == 1)
     {
         line->length = 1;
-        line->moves[0] = s_moves[0];
+        line->moves[0] = s_generatedMoves[0];
         return true;
     }
     else
@@ -793,13 +1088,16 @@ static inline bool OpeningBookLine(const Board * board, MoveLine * line)
     return false;
 }
 
-bool EvalStart(const Board * board, uint32_t maxTime, uint32_t maxDepth, MoveLine * bestLine)
+bool EvalStart(const Board * board, const RepetitionStack * history, uint32_t maxTime, uint32_t maxDepth, MoveLine * bestLine)
 {
-#ifdef _MSC_VER
-    s_ticks = 0;
-#endif
-
     s_evalCanceled = false;
+    s_positionsEvaluated = 0;
+    s_ttProbes = 0;
+    s_ttProbeHits = 0;
+    SearchStatsClear(&s_searchStats);
+    ProfileReset();
+    // Opt-in; see SEARCH_TRACE. Searches run on worker threads, so the trace is opened by the thread which searches.
+    SearchTraceOpen(SEARCH_TRACE_DEFAULT_CAPACITY);
 
     if (OpeningBookLine(board, bestLine))
         return true;
@@ -814,16 +1112,11 @@ bool EvalStart(const Board * board, uint32_t maxTime, uint32_t maxDepth, MoveLin
 
     EvalClear();
 
+    if (!RepetitionStackCopy(&s_repetitionStack, history))
+        return false;
+
     int32_t score = 0;
 
-    s_lmrPruning = 0;
-    s_nullMovePruning = 0;
-    s_repetitions = 0;
-    s_extensions = 0;
-    s_positionsEvaluated = 0;
-    s_betaCutoffs = 0;
-    s_alphaUpdates = 0;
-    s_ttHits = 0;
     s_selDepth = 0;
 
     memset(s_killerMoves, 0, sizeof(s_killerMoves));
@@ -842,11 +1135,12 @@ bool EvalStart(const Board * board, uint32_t maxTime, uint32_t maxDepth, MoveLin
 #define BETA_ASPIRATION_DEFAULT 600
     int32_t alphaAspirationQty = ALPHA_ASPIRATION_DEFAULT;
     int32_t betaAspirationQty = BETA_ASPIRATION_DEFAULT;
-    int aspirationFailures = 0;
     for (; depth <= (int)maxDepth; ++depth)
     {
         s_selDepth = 0;
         line.length = 0;
+        s_searchStack[0].pliesFromNull = MAX_LINE_DEPTH * 4; // No null move before the root; more than any halfmove counter.
+        TraceSetMove(0, 0, 0);
         score = Minimax(board, alphaAspirated, betaAspirated, depth, 0, bestLine, &line, 0, 0, true);
 
         // Aspiration windows. Use a tighter tolerance for alpha and beta on successive iterations to hopefully cull
@@ -858,7 +1152,7 @@ bool EvalStart(const Board * board, uint32_t maxTime, uint32_t maxDepth, MoveLin
             alphaAspirated = score - alphaAspirationQty;
             alphaAspirationQty *= 2;
             --depth; // Search again at same depth.
-            aspirationFailures++;
+            SearchStatsEvent(&s_searchStats, SearchEventAspirationFailure);
             continue;
         }
         else if (score >= betaAspirated)
@@ -867,7 +1161,7 @@ bool EvalStart(const Board * board, uint32_t maxTime, uint32_t maxDepth, MoveLin
             betaAspirated = score + betaAspirationQty;
             betaAspirationQty *= 2;
             --depth; // Search again at same depth.
-            aspirationFailures++;
+            SearchStatsEvent(&s_searchStats, SearchEventAspirationFailure);
             continue;
         }
         else
@@ -952,42 +1246,44 @@ bool EvalStart(const Board * board, uint32_t maxTime, uint32_t maxDepth, MoveLin
 #endif
     }
 
-#if 0
-#if 1
-    printf("repetitions: %" PRIu64 "\n", s_repetitions);
+#if SEARCH_STATS
+    if (g_optionDebugMode)
+        SearchStatsPrint(&s_searchStats);
 #endif
 
-#if 1
-    printf("Avg moves: %f\n", (float) s_avgMoveOrderer / (float) s_avgMoveOrdererCnt);
-#endif
-
-#if 1
-    printf("Aspiration failures: %i\n", aspirationFailures);
-#endif
-
-#if 1
-    printf("tthits: %" PRIu64 "\n", s_ttHits);
+#if PROFILING
+    if (g_optionDebugMode)
+    {
+        ProfileCounters profile;
+        ProfileCountersClear(&profile);
+        ProfileAccumulate(&profile);
+        ProfilePrint(&profile);
+    }
 #endif
 
-#if 1
-    printf("Beta cutoffs: %" PRIu64 "\n", s_betaCutoffs);
-#endif
+    return bestLine->length > 0;
+}
 
-#if 1
-    printf("Alpha updates: %" PRIu64 "\n", s_alphaUpdates);
-#endif
+uint64_t EvalGetNodeCount()
+{
+    return s_positionsEvaluated;
+}
 
-#if 0
-#ifdef _MSC_VER
-    LARGE_INTEGER frequency;
-    QueryPerformanceFrequency(&frequency);
-    printf("Profiling: %i ms\n", (int)(1000 * s_ticks / frequency.QuadPart));
-#endif
-#endif
+void EvalGetTTStats(uint64_t * probes, uint64_t * hits)
+{
+    *probes = s_ttProbes;
+    *hits = s_ttProbeHits;
+}
 
-#endif
+void EvalAccumulateSearchStats(SearchStats * total)
+{
+    SearchStatsAccumulate(total, &s_searchStats);
+}
 
-    return bestLine->length > 0;
+void EvalPrintStats()
+{
+    SearchStatsPrint(&s_searchStats);
+    TranspositionTablePrintStats(&s_transpositionTable);
 }
 
 void EvalStop()
@@ -1001,8 +1297,8 @@ bool EvalInit(size_t numTTBuckets)
     if (!TranspositionTableInitialize(&s_transpositionTable, numTTBuckets))
         return false;
 
-    // 16MB starting cache size for repetition table; can grow indefinitely.
-    if (!RepetitionTableInitialize(&s_repetitionTable, 0x40000))
+    // Room for the game history of a long game; grows as needed when the history is copied in.
+    if (!RepetitionStackInitialize(&s_repetitionStack, 1024))
         return false;
 
     StaticEvalInitialize();
@@ -1013,11 +1309,10 @@ bool EvalInit(size_t numTTBuckets)
 void EvalClear()
 {
     TranspositionTableClear(&s_transpositionTable);
-    RepetitionTableClear(&s_repetitionTable);
 }
 
 void EvalDestroy()
 {
     TranspositionTableDestroy(&s_transpositionTable);
-    RepetitionTableDestroy(&s_repetitionTable);
+    RepetitionStackDestroy(&s_repetitionStack);
 }
@@ -4,6 +4,8 @@
 #include "Board.h"
 #include "MoveLine.h"
 #include "Player.h"
+#include "Repetition.h"
+#include "SearchStats.h"
 
 #include <stdbool.h>
 #include <stdint.h>
@@ -29,8 +31,17 @@
 // Black delivered checkmate and won.
 #define CHECKMATE_BLACK (-CHECKMATE_WHITE)
 
-extern bool EvalStart(const Board * board, uint32_t maxTime, uint32_t maxDepth, MoveLine * bestLine);
+extern bool EvalStart(const Board * board, const RepetitionStack * history, uint32_t maxTime, uint32_t maxDepth, MoveLine * bestLine);
 extern void EvalStop();
+// Number of nodes searched by the last (or current) EvalStart.
+extern uint64_t EvalGetNodeCount();
+// Transposition table probes by the last (or current) EvalStart, and how many of them found an entry for the position.
+// Both are zero when the search does not use the transposition table.
+extern void EvalGetTTStats(uint64_t * probes, uint64_t * hits);
+// Adds the search statistics of the last (or current) EvalStart to total; see SearchStats.h.
+extern void EvalAccumulateSearchStats(SearchStats * total);
+// Prints the search statistics of the last (or current) EvalStart; see SearchStats.h.
+extern void EvalPrintStats();
 extern bool EvalInit(size_t numTTBuckets);
 extern void EvalClear();
 extern void EvalDestroy();
@@ -1,5 +1,4 @@
 #include "FEN.h"
-#include "StaticEval.h"
 #include "Zobrist.h"
 
 #include <stdio.h>
@@ -285,19 +284,6 @@ extern bool ParseFEN(const char * fen, Board * board)
             {
                 if (file != FileH + 1 || rank != Rank1)
                     return false;
-
-                // Fill out the various piece table combinations.
-                board->whitePieceTables[PIECE_TABLE_COMBINED] = board->whitePieceTables[PIECE_TABLE_PAWNS] |
-                    board->whitePieceTables[PIECE_TABLE_KNIGHTS] |
-                    board->whitePieceTables[PIECE_TABLE_BISHOPS_QUEENS] |
-                    board->whitePieceTables[PIECE_TABLE_ROOKS_QUEENS] |
-                    SquareEncode(board->whiteKingSquare);
-                board->blackPieceTables[PIECE_TABLE_COMBINED] = board->blackPieceTables[PIECE_TABLE_PAWNS] |
-                    board->blackPieceTables[PIECE_TABLE_KNIGHTS] |
-                    board->blackPieceTables[PIECE_TABLE_BISHOPS_QUEENS] |
-                    board->blackPieceTables[PIECE_TABLE_ROOKS_QUEENS] |
-                    SquareEncode(board->blackKingSquare);
-                board->allPieceTables = board->whitePieceTables[PIECE_TABLE_COMBINED] | board->blackPieceTables[PIECE_TABLE_COMBINED];
             }
 
             field++;
@@ -319,47 +305,47 @@ extern bool ParseFEN(const char * fen, Board * board)
                     if (file > FileH)
                         return false;
 
-                    EncodedSquare square = SquareEncodeRankFile(rank, file);
+                    Square square = SquareFromRankFile(rank, file);
 
                     switch (c)
                     {
                     case 'b': // Black bishop
-                        board->blackPieceTables[PIECE_TABLE_BISHOPS_QUEENS] |= square;
+                        BoardAddPiece(board, Black, Bishop, square);
                         break;
                     case 'k': // Black king
-                        board->blackKingSquare = SquareFromRankFile(rank, file);
+                        board->blackKingSquare = square;
+                        BoardAddPiece(board, Black, King, square);
                         break;
                     case 'n': // Black knight
-                        board->blackPieceTables[PIECE_TABLE_KNIGHTS] |= square;
+                        BoardAddPiece(board, Black, Knight, square);
                         break;
                     case 'p': // Black pawn
-                        board->blackPieceTables[PIECE_TABLE_PAWNS] |= square;
+                        BoardAddPiece(board, Black, Pawn, square);
                         break;
                     case 'q': // Black queen
-                        board->blackPieceTables[PIECE_TABLE_BISHOPS_QUEENS] |= square;
-                        board->blackPieceTables[PIECE_TABLE_ROOKS_QUEENS] |= square;
+                        BoardAddPiece(board, Black, Queen, square);
                         break;
                     case 'r': // Black rook
-                        board->blackPieceTables[PIECE_TABLE_ROOKS_QUEENS] |= square;
+                        BoardAddPiece(board, Black, Rook, square);
                         break;
                     case 'B': // White bishop
-                        board->whitePieceTables[PIECE_TABLE_BISHOPS_QUEENS] |= square;
+                        BoardAddPiece(board, White, Bishop, square);
                         break;
                     case 'K': // White king
-                        board->whiteKingSquare = SquareFromRankFile(rank, file);
+                        board->whiteKingSquare = square;
+                        BoardAddPiece(board, White, King, square);
                         break;
                     case 'N': // White knight
-                        board->whitePieceTables[PIECE_TABLE_KNIGHTS] |= square;
+                        BoardAddPiece(board, White, Knight, square);
                         break;
                     case 'P': // White pawn
-                        board->whitePieceTables[PIECE_TABLE_PAWNS] |= square;
+                        BoardAddPiece(board, White, Pawn, square);
                         break;
                     case 'Q': // White queen
-                        board->whitePieceTables[PIECE_TABLE_BISHOPS_QUEENS] |= square;
-                        board->whitePieceTables[PIECE_TABLE_ROOKS_QUEENS] |= square;
+                        BoardAddPiece(board, White, Queen, square);
                         break;
                     case 'R': // White rook
-                        board->whitePieceTables[PIECE_TABLE_ROOKS_QUEENS] |= square;
+                        BoardAddPiece(board, White, Rook, square);
                         break;
                     case '1': // Empty square(s)
                     case '2':
@@ -469,8 +455,6 @@ extern bool ParseFEN(const char * fen, Board * board)
     }
 
     board->hash = ZobristCalculate(board);
-    board->materialHash = ZobristCalculateMaterialHash(board);
-    board->staticEval = Evaluate(board);
 
     return file == FileH + 1 && rank == Rank1;
 }
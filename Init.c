@@ -1,166 +1,74 @@
 #include "Init.h"
 
+#include "Intrinsics.h"
 #include "tables/MoveTables.h"
+#include "tables/SliderAttacks.h"
 
-#ifdef __GNUC__
-#include <alloca.h>
-#endif
-#include <assert.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
+#include <stddef.h>
 
-#if defined(_WIN32) || defined(WIN32)
-#include "WindowsInclude.h"
-#define FILE_PATH_SEPARATOR "\\"
-#define FILE_PATH_SEPARATOR_CHAR '\\'
-#else
-#include <linux/limits.h>
-#include <unistd.h>
-#define FILE_PATH_SEPARATOR "/"
-#define FILE_PATH_SEPARATOR_CHAR '/'
-#endif
-
-static const char * GetExecutableDirectory()
+static void InitSliderAttackTables(SliderAttackTable * tables, const uint64_t * attackPool, const uint64_t * blockerMasks, const uint64_t * moveBitboards, const uint64_t * magics, const uint8_t * indexBits)
 {
-    static char * s_execDir = NULL;
-    if (s_execDir == NULL)
+    for (int i = 0; i < NUM_SQUARES; ++i)
     {
-#if defined(_WIN32) || defined(WIN32)
-        static char buf[MAX_PATH + 1];
-        memset(buf, 0, sizeof(buf));
-        GetModuleFileNameA(NULL, buf, sizeof(buf));
-        s_execDir = buf;
-#else
-        static char buf[PATH_MAX + 1];
-        memset(buf, 0, sizeof(buf));
-        ssize_t size = readlink("/proc/self/exe", buf, sizeof(buf));
-        if (size == -1)
-            return "";
-        s_execDir = buf;
-#endif
-        char * k = strrchr(s_execDir, FILE_PATH_SEPARATOR_CHAR);
-        if (k != NULL)
-            *k = '\0';
+        tables[i].blockerMask = blockerMasks[i];
+        tables[i].magic = magics[i];
+        tables[i].attackIndices = NULL;
+        tables[i].attackPool = attackPool;
+        tables[i].moveBitboard = moveBitboards[i];
+        tables[i].indexBits = indexBits[i];
     }
-    return s_execDir;
 }
 
-static int LoadRookBlockerBitboards(const char * bitboardsDir)
+// Points each square into its slice of a contiguous index table. Both backends lay the slices out in the same order.
+static void SetSliderAttackIndices(SliderAttackTable * tables, const uint16_t * attackIndices)
 {
-    static const char * const rookBlockerBitboardsFilename = "rookBlockerBitboards.bin";
-    size_t filePathLen = strlen(bitboardsDir) + strlen(rookBlockerBitboardsFilename) + 2; // +2 is for path separator and null terminator
-    char * rookBlockerBitboardsPath = (char *) alloca(filePathLen);
-    int z = snprintf(rookBlockerBitboardsPath, filePathLen, "%s" FILE_PATH_SEPARATOR "%s", bitboardsDir, rookBlockerBitboardsFilename);
-    if (z != filePathLen - 1)
-        return 1;
-
-    FILE * rookBlockerBitboardsFile = fopen(rookBlockerBitboardsPath, "rb");
-    if (rookBlockerBitboardsFile == NULL)
-        return 1;
-
-    fseek(rookBlockerBitboardsFile, 0, SEEK_END);
-    long len = ftell(rookBlockerBitboardsFile);
-    if (len % sizeof(uint64_t) != 0)
-        return 1;
-    rewind(rookBlockerBitboardsFile);
-    s_rookBlockerBitboardsContiguous = (uint64_t *) malloc(len);
-    if (!s_rookBlockerBitboardsContiguous)
-        return 1;
-    if (sizeof(uint64_t) != fread(s_rookBlockerBitboardsContiguous, len >> 3, sizeof(uint64_t), rookBlockerBitboardsFile))
-        return 1;
-    fclose(rookBlockerBitboardsFile);
-
-    static const uint64_t MagicBitboardLenPerSquare[NUM_SQUARES] =
-    {
-        12, 11, 11, 11, 11, 11, 11, 12, // Rank 1
-        11, 10, 10, 10, 10, 10, 10, 11, // Rank 2
-        11, 10, 10, 10, 10, 10, 10, 11, // Rank 3
-        11, 10, 10, 10, 10, 10, 10, 11, // Rank 4
-        11, 10, 10, 10, 10, 10, 10, 11, // Rank 5
-        11, 10, 10, 10, 10, 10, 10, 11, // Rank 6
-        11, 10, 10, 10, 10, 10, 10, 11, // Rank 7
-        12, 11, 11, 11, 11, 11, 11, 12  // Rank 8
-    };
-
-    s_rookBlockerBitboards[0] = s_rookBlockerBitboardsContiguous;
-    for (int i = 1; i < NUM_SQUARES; ++i)
+    for (int i = 0; i < NUM_SQUARES; ++i)
     {
-        s_rookBlockerBitboards[i] = s_rookBlockerBitboards[i - 1] + (1ull << MagicBitboardLenPerSquare[i - 1]);
-        assert(s_rookBlockerBitboards[i] < s_rookBlockerBitboardsContiguous + (len >> 3));
+        tables[i].attackIndices = attackIndices;
+        attackIndices += 1ull << tables[i].indexBits;
     }
-
-    return 0;
 }
 
-static int LoadBishopBlockerBitboards(const char * bitboardsDir)
+bool SliderBackendSupported(SliderBackend backend)
 {
-    static const char * const bishopBlockerBitboardsFilename = "bishopBlockerBitboards.bin";
-    size_t filePathLen = strlen(bitboardsDir) + strlen(bishopBlockerBitboardsFilename) + 2; // +2 is for path separator and null terminator
-    char * bishopBlockerBitboardsPath = (char *) alloca(filePathLen);
-    if (snprintf(bishopBlockerBitboardsPath, filePathLen, "%s" FILE_PATH_SEPARATOR "%s", bitboardsDir, bishopBlockerBitboardsFilename) != filePathLen - 1)
-        return 1;
+    return backend != SliderBackendPext || intrinsic_cpu_has_bmi2();
+}
 
-    FILE * bishopBlockerBitboardsFile = fopen(bishopBlockerBitboardsPath, "rb");
-    if (bishopBlockerBitboardsFile == NULL)
-        return 1;
+SliderBackend GetPreferredSliderBackend()
+{
+    return intrinsic_cpu_has_fast_pext() ? SliderBackendPext : SliderBackendMagic;
+}
 
-    fseek(bishopBlockerBitboardsFile, 0, SEEK_END);
-    long len = ftell(bishopBlockerBitboardsFile);
-    if (len % sizeof(uint64_t) != 0)
-        return 1;
-    rewind(bishopBlockerBitboardsFile);
-    s_bishopBlockerBitboardsContiguous = (uint64_t *) malloc(len);
-    if (!s_bishopBlockerBitboardsContiguous)
-        return 1;
-    if (sizeof(uint64_t) != fread(s_bishopBlockerBitboardsContiguous, len >> 3, sizeof(uint64_t), bishopBlockerBitboardsFile))
-        return 1;
-    fclose(bishopBlockerBitboardsFile);
+bool SetSliderBackend(SliderBackend backend)
+{
+    if (!SliderBackendSupported(backend))
+        return false;
 
-    static const uint64_t MagicBitboardLenPerSquare[NUM_SQUARES] =
+    if (backend == SliderBackendMagic)
     {
-        6, 5, 5, 5, 5, 5, 5, 6, // Rank 1
-        5, 5, 5, 5, 5, 5, 5, 5, // Rank 2
-        5, 5, 7, 7, 7, 7, 5, 5, // Rank 3
-        5, 5, 7, 9, 9, 7, 5, 5, // Rank 4
-        5, 5, 7, 9, 9, 7, 5, 5, // Rank 5
-        5, 5, 7, 7, 7, 7, 5, 5, // Rank 6
-        5, 5, 5, 5, 5, 5, 5, 5, // Rank 7
-        6, 5, 5, 5, 5, 5, 5, 6  // Rank 8
-    };
-
-    s_bishopBlockerBitboards[0] = s_bishopBlockerBitboardsContiguous;
-    for (int i = 1; i < NUM_SQUARES; ++i)
+        SetSliderAttackIndices(s_rookAttackTables, s_rookMagicAttackIndices);
+        SetSliderAttackIndices(s_bishopAttackTables, s_bishopMagicAttackIndices);
+    }
+    else
     {
-        s_bishopBlockerBitboards[i] = s_bishopBlockerBitboards[i - 1] + (1ull << MagicBitboardLenPerSquare[i - 1]);
-        assert(s_bishopBlockerBitboards[i] < s_bishopBlockerBitboardsContiguous + (len >> 3));
+        SetSliderAttackIndices(s_rookAttackTables, s_rookPextAttackIndices);
+        SetSliderAttackIndices(s_bishopAttackTables, s_bishopPextAttackIndices);
     }
 
-    return 0;
+    g_sliderBackend = backend;
+    return true;
 }
 
-int Init(const char * bitboardsDir)
+// The slider tables are const data linked into the binary (see tools/BitboardGeneration.c), so there is nothing to
+// load; only the small per-square lookup structs are filled in.
+int Init()
 {
-    const char * dir = (bitboardsDir != NULL) ? bitboardsDir : GetExecutableDirectory();
+    InitSliderAttackTables(s_rookAttackTables, s_rookAttackPool, s_rookBlockerMasks, s_rookMoveBitboard, s_rookMagics, s_rookBlockerIndexBits);
+    InitSliderAttackTables(s_bishopAttackTables, s_bishopAttackPool, s_bishopBlockerMasks, s_bishopMoveBitboard, s_bishopMagics, s_bishopBlockerIndexBits);
 
-    int result = LoadRookBlockerBitboards(dir);
-    if (result != 0)
-        return result;
-
-    return LoadBishopBlockerBitboards(dir);
+    return SetSliderBackend(GetPreferredSliderBackend()) ? 0 : 1;
 }
 
 void Cleanup()
 {
-    if (s_bishopBlockerBitboardsContiguous)
-    {
-        free(s_bishopBlockerBitboardsContiguous);
-        s_bishopBlockerBitboardsContiguous = 0;
-    }
-
-    if (s_rookBlockerBitboardsContiguous)
-    {
-        free(s_rookBlockerBitboardsContiguous);
-        s_rookBlockerBitboardsContiguous = 0;
-    }
 }
@@ -1,7 +1,16 @@
 #ifndef INIT_H_
 #define INIT_H_
 
-extern int Init(const char * bitboardsDir);
+#include "tables/MoveTables.h"
+
+#include <stdbool.h>
+
+extern int Init();
 extern void Cleanup();
 
+// Slider backend selection. Init() selects the preferred backend for the executing CPU.
+extern bool SliderBackendSupported(SliderBackend backend);
+extern SliderBackend GetPreferredSliderBackend();
+extern bool SetSliderBackend(SliderBackend backend);
+
 #endif // INIT_H_
@@ -4,6 +4,7 @@
 #ifdef _MSC_VER
 #include <intrin.h>
 #elif defined(__GNUC__)
+#include <cpuid.h>
 #include <x86intrin.h>
 #endif
 
@@ -106,7 +107,16 @@ static FORCE_INLINE int intrinsic_popcnt64(uint64_t x)
 #error Platform not supported (missing popcnt instrinsic)
 #endif
 
-static FORCE_INLINE unsigned long long intrinsic_pext64(unsigned long long x, unsigned long long mask)
+// PEXT/PDEP are only used by the PEXT slider backend, which is selected at runtime when the CPU supports BMI2.
+// Builds without -mbmi2 (portable builds) therefore compile just these functions for BMI2; they cannot be
+// force-inlined into callers compiled for a lower target.
+#if defined(__GNUC__) && !defined(__BMI2__)
+#define BMI2_FUNCTION static inline __attribute__((target("bmi2")))
+#else
+#define BMI2_FUNCTION static FORCE_INLINE
+#endif
+
+BMI2_FUNCTION unsigned long long intrinsic_pext64(unsigned long long x, unsigned long long mask)
 {
 #if defined(_MSC_VER) || defined(__GNUC__)
     return _pext_u64(x, mask);
@@ -115,7 +125,7 @@ static FORCE_INLINE unsigned long long intrinsic_pext64(unsigned long long x, un
 #endif
 }
 
-static FORCE_INLINE unsigned long long intrinsic_pdep64(unsigned long long x, unsigned long long mask)
+BMI2_FUNCTION unsigned long long intrinsic_pdep64(unsigned long long x, unsigned long long mask)
 {
 #if defined(_MSC_VER) || defined(__GNUC__)
     return _pdep_u64(x, mask);
@@ -126,10 +136,10 @@ static FORCE_INLINE unsigned long long intrinsic_pdep64(unsigned long long x, un
 
 static FORCE_INLINE unsigned long long intrinsic_blsr64(unsigned long long x)
 {
-#if defined(_MSC_VER) || defined(__GNUC__)
+#if defined(_MSC_VER) || defined(__BMI__)
     return _blsr_u64(x);
 #else
-#error Platform not supported (missing pext64 instrinsic)
+    return x & (x - 1);
 #endif
 }
 
@@ -139,10 +149,10 @@ static FORCE_INLINE unsigned long long intrinsic_andn64(unsigned long long x, un
 {
 #if defined(_MSC_VER)
     return _andn_u64(x, y);
-#elif defined(__GNUC__)
+#elif defined(__BMI__)
     return __andn_u64(x, y);
 #else
-#error Platform not supported (missing pext64 instrinsic)
+    return ~x & y;
 #endif
 }
 
@@ -179,4 +189,56 @@ static FORCE_INLINE unsigned long long intrinsic_bswap64(unsigned long long x)
 #endif
 }
 
+// Whether the CPU executing this process supports the BMI2 instruction set (PEXT/PDEP).
+static inline bool intrinsic_cpu_has_bmi2()
+{
+#if defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7)
+        return false;
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 8)) != 0;
+#elif defined(__GNUC__)
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return false;
+    return (ebx & (1 << 8)) != 0;
+#else
+    return false;
+#endif
+}
+
+// Whether PEXT/PDEP are implemented in hardware with single-digit latency. AMD CPUs before Zen 3 (family 19h)
+// implement them in microcode, where the latency depends on the number of bits in the mask and a magic multiply
+// is several times faster.
+static inline bool intrinsic_cpu_has_fast_pext()
+{
+    if (!intrinsic_cpu_has_bmi2())
+        return false;
+
+    unsigned int regs[4];
+#if defined(_MSC_VER)
+    __cpuid((int *) regs, 0);
+#elif defined(__GNUC__)
+    __cpuid(0, regs[0], regs[1], regs[2], regs[3]);
+#else
+    return false;
+#endif
+    // Vendor string is stored in ebx, edx, ecx.
+    bool amd = regs[1] == 0x68747541 && regs[3] == 0x69746e65 && regs[2] == 0x444d4163; // "AuthenticAMD"
+    if (!amd)
+        return true;
+
+#if defined(_MSC_VER)
+    __cpuid((int *) regs, 1);
+#else
+    __cpuid(1, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    unsigned int family = (regs[0] >> 8) & 0xF;
+    if (family == 0xF)
+        family += (regs[0] >> 20) & 0xFF;
+    return family >= 0x19;
+}
+
 #endif // INTRINSICS_H_
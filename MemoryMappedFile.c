@@ -96,6 +96,64 @@ bool MemoryMappedFileOpen(MemoryMappedFile * file, const char * filename)
     return true;
 }
 
+bool MemoryMappedFileCreate(MemoryMappedFile * file, const char * filename, uint64_t length)
+{
+    if (file->baseAddress != NULL)
+        return false; // Already open.
+
+#ifndef _WIN32
+    int fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+    if (fd == -1)
+        return false;
+
+    if (ftruncate(fd, (off_t)length) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    file->baseAddress = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (file->baseAddress == MAP_FAILED)
+    {
+        fprintf(stderr, "Could not mmap() %s\n", filename);
+        file->baseAddress = NULL;
+        file->length = 0;
+        return false;
+    }
+#else
+    HANDLE fd = CreateFileA(filename, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL,
+                            CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (fd == INVALID_HANDLE_VALUE || fd == NULL)
+        return false;
+
+    file->handle = CreateFileMapping(fd, NULL, PAGE_READWRITE, (DWORD)(length >> 32), (DWORD)length, NULL);
+    CloseHandle(fd);
+
+    if (file->handle == INVALID_HANDLE_VALUE || file->handle == NULL)
+    {
+        fprintf(stderr, "CreateFileMapping() failed\n");
+        return false;
+    }
+
+    file->baseAddress = MapViewOfFile(file->handle, FILE_MAP_WRITE, 0, 0, 0);
+
+    if (file->baseAddress == NULL)
+    {
+        fprintf(stderr, "MapViewOfFile() failed, name = %s, error = %d\n", filename, GetLastError());
+        CloseHandle(file->handle);
+        file->handle = INVALID_HANDLE_VALUE;
+        return false;
+    }
+#endif
+
+    file->length = length;
+    return true;
+}
+
 void MemoryMappedFileClose(MemoryMappedFile * file)
 {
     if (file->baseAddress != NULL)
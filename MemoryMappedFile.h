@@ -20,6 +20,8 @@ extern void MemoryMappedFileInitialize(MemoryMappedFile * file);
 extern bool MemoryMappedFileInitializeAndOpen(MemoryMappedFile * file, const char * filename);
 extern void MemoryMappedFileDestroy(MemoryMappedFile * file);
 extern bool MemoryMappedFileOpen(MemoryMappedFile * file, const char * filename);
+// Creates, or truncates, a file of the given length and maps it for reading and writing.
+extern bool MemoryMappedFileCreate(MemoryMappedFile * file, const char * filename, uint64_t length);
 extern void MemoryMappedFileClose(MemoryMappedFile * file);
 
 static inline uint64_t MemoryMappedFileGetSize(MemoryMappedFile * file)
@@ -50,16 +50,24 @@ static FORCE_INLINE EncodedSquare GetKnightMoves(Square square)
     return s_knightMoveBitboard[square];
 }
 
+static FORCE_INLINE EncodedSquare GetSliderMoves(EncodedSquare occupiedSquares, const SliderAttackTable * table)
+{
+    uint64_t index;
+    if (g_sliderBackend == SliderBackendPext)
+        index = intrinsic_pext64(occupiedSquares, table->blockerMask);
+    else
+        index = ((occupiedSquares & table->blockerMask) * table->magic) >> (64 - table->indexBits);
+    return table->moveBitboard & table->attackPool[table->attackIndices[index]];
+}
+
 static FORCE_INLINE EncodedSquare GetBishopMoves(EncodedSquare occupiedSquares, Square square)
 {
-    // TODO: Better cache coherency: s_bishopBlockerBitboards[square] and s_bishopBlockerMasks[square] should be grouped in a single struct to avoid cache thrashing.
-    // Same for rooks.
-    return s_bishopMoveBitboard[square] & s_bishopBlockerBitboards[square][intrinsic_pext64(occupiedSquares, s_bishopBlockerMasks[square])];
+    return GetSliderMoves(occupiedSquares, &s_bishopAttackTables[square]);
 }
 
 static FORCE_INLINE EncodedSquare GetRookMoves(EncodedSquare occupiedSquares, Square square)
 {
-    return s_rookMoveBitboard[square] & s_rookBlockerBitboards[square][intrinsic_pext64(occupiedSquares, s_rookBlockerMasks[square])];
+    return GetSliderMoves(occupiedSquares, &s_rookAttackTables[square]);
 }
 
 static FORCE_INLINE EncodedSquare GetQueenMoves(EncodedSquare occupiedSquares, Square square)
@@ -67,6 +75,89 @@ static FORCE_INLINE EncodedSquare GetQueenMoves(EncodedSquare occupiedSquares, S
     return GetBishopMoves(occupiedSquares, square) | GetRookMoves(occupiedSquares, square);
 }
 
+// Set-wise slider attacks: the union of the attacks of a whole set of sliders, computed with Kogge-Stone occluded fills
+// instead of one table lookup per slider. Each direction is filled in three shift steps, regardless of the number of
+// sliders. With AVX2 the four directions of a slider type are filled in parallel, one per 64 bit lane; lanes which
+// shift the other way use a shift count of 64, which shifts everything out.
+#define SETWISE_NOT_FILE_A 0xFEFEFEFEFEFEFEFEull
+#define SETWISE_NOT_FILE_H 0x7F7F7F7F7F7F7F7Full
+
+#if defined(__AVX2__)
+static FORCE_INLINE __m256i SetwiseShift(__m256i bits, __m256i leftShifts, __m256i rightShifts)
+{
+    return _mm256_or_si256(_mm256_sllv_epi64(bits, leftShifts), _mm256_srlv_epi64(bits, rightShifts));
+}
+
+static FORCE_INLINE EncodedSquare GetSetwiseSliderMoves(EncodedSquare sliders, EncodedSquare occupiedSquares, __m256i leftShifts, __m256i rightShifts, __m256i wrapMasks)
+{
+    __m256i generator = _mm256_set1_epi64x((long long) sliders);
+    __m256i propagator = _mm256_andnot_si256(_mm256_set1_epi64x((long long) occupiedSquares), wrapMasks);
+    __m256i left = leftShifts;
+    __m256i right = rightShifts;
+    for (int i = 0; i < 3; ++i)
+    {
+        generator = _mm256_or_si256(generator, _mm256_and_si256(propagator, SetwiseShift(generator, left, right)));
+        propagator = _mm256_and_si256(propagator, SetwiseShift(propagator, left, right));
+        left = _mm256_add_epi64(left, left);
+        right = _mm256_add_epi64(right, right);
+    }
+    __m256i attacks = _mm256_and_si256(SetwiseShift(generator, leftShifts, rightShifts), wrapMasks);
+    __m128i halves = _mm_or_si128(_mm256_castsi256_si128(attacks), _mm256_extracti128_si256(attacks, 1));
+    return (EncodedSquare) (_mm_cvtsi128_si64(halves) | _mm_extract_epi64(halves, 1));
+}
+
+static FORCE_INLINE EncodedSquare GetSetwiseBishopMoves(EncodedSquare bishops, EncodedSquare occupiedSquares)
+{
+    // North east, north west, south east, south west.
+    return GetSetwiseSliderMoves(bishops, occupiedSquares,
+        _mm256_setr_epi64x(9, 7, 64, 64),
+        _mm256_setr_epi64x(64, 64, 7, 9),
+        _mm256_setr_epi64x(SETWISE_NOT_FILE_A, SETWISE_NOT_FILE_H, SETWISE_NOT_FILE_A, SETWISE_NOT_FILE_H));
+}
+
+static FORCE_INLINE EncodedSquare GetSetwiseRookMoves(EncodedSquare rooks, EncodedSquare occupiedSquares)
+{
+    // North, east, south, west.
+    return GetSetwiseSliderMoves(rooks, occupiedSquares,
+        _mm256_setr_epi64x(8, 1, 64, 64),
+        _mm256_setr_epi64x(64, 64, 8, 1),
+        _mm256_setr_epi64x(-1, SETWISE_NOT_FILE_A, -1, SETWISE_NOT_FILE_H));
+}
+#else
+static FORCE_INLINE EncodedSquare SetwiseShift(EncodedSquare bits, int offset)
+{
+    return (offset > 0) ? (bits << offset) : (bits >> -offset);
+}
+
+static FORCE_INLINE EncodedSquare GetSetwiseSliderMovesInDirection(EncodedSquare sliders, EncodedSquare occupiedSquares, int offset, EncodedSquare wrapMask)
+{
+    EncodedSquare generator = sliders;
+    EncodedSquare propagator = intrinsic_andn64(occupiedSquares, wrapMask);
+    generator |= propagator & SetwiseShift(generator, offset);
+    propagator &= SetwiseShift(propagator, offset);
+    generator |= propagator & SetwiseShift(generator, offset * 2);
+    propagator &= SetwiseShift(propagator, offset * 2);
+    generator |= propagator & SetwiseShift(generator, offset * 4);
+    return SetwiseShift(generator, offset) & wrapMask;
+}
+
+static FORCE_INLINE EncodedSquare GetSetwiseBishopMoves(EncodedSquare bishops, EncodedSquare occupiedSquares)
+{
+    return GetSetwiseSliderMovesInDirection(bishops, occupiedSquares, 9, SETWISE_NOT_FILE_A) |
+        GetSetwiseSliderMovesInDirection(bishops, occupiedSquares, 7, SETWISE_NOT_FILE_H) |
+        GetSetwiseSliderMovesInDirection(bishops, occupiedSquares, -7, SETWISE_NOT_FILE_A) |
+        GetSetwiseSliderMovesInDirection(bishops, occupiedSquares, -9, SETWISE_NOT_FILE_H);
+}
+
+static FORCE_INLINE EncodedSquare GetSetwiseRookMoves(EncodedSquare rooks, EncodedSquare occupiedSquares)
+{
+    return GetSetwiseSliderMovesInDirection(rooks, occupiedSquares, 8, ~0ull) |
+        GetSetwiseSliderMovesInDirection(rooks, occupiedSquares, 1, SETWISE_NOT_FILE_A) |
+        GetSetwiseSliderMovesInDirection(rooks, occupiedSquares, -8, ~0ull) |
+        GetSetwiseSliderMovesInDirection(rooks, occupiedSquares, -1, SETWISE_NOT_FILE_H);
+}
+#endif
+
 static FORCE_INLINE EncodedSquare GetKingMoves(Square square)
 {
     return s_kingMoveBitboard[square];
@@ -75,22 +166,11 @@ static FORCE_INLINE EncodedSquare GetKingMoves(Square square)
 //#define MAKE_UNMAKE_MOVE
 
 #ifdef MAKE_UNMAKE_MOVE
-typedef enum
-{
-    CapturedNone = 0,
-    CapturedPawn = 1 << 0,
-    CapturedKnight = 1 << 1,
-    CapturedBishop = 1 << 2,
-    CapturedRook = 1 << 3,
-    CapturedQueen = CapturedBishop | CapturedRook
-} CapturedPiece;
-
 typedef struct
 {
     Square enPassantSquare;
-    int32_t staticEval;
     uint8_t halfmoveCounter;
-    uint8_t capturedPiece;
+    PieceType capturedPiece;
     uint8_t castleBits;
 
 } MakeUnmakeState;
@@ -104,12 +184,42 @@ extern bool MakeMove2(Board * board, Move move, Player * player);
 extern void MakeNullMove(Board * board);
 #endif
 
+// Check and pin information for the player to move, computed once per position so that pseudo-legal moves
+// can be validated and classified as checking moves with bitmask tests, rather than recomputing slider
+// attacks on the king for every move.
+typedef struct
+{
+    EncodedSquare checkers; // Opponent pieces giving check to the player to move.
+    EncodedSquare pinned; // Friendly pieces pinned to the friendly king.
+    EncodedSquare discoveredCheckCandidates; // Friendly pieces which are the only blocker between a friendly slider and the opponent king.
+    EncodedSquare checkSquares[NUM_PIECE_TYPES + 1]; // Indexed by PieceType; squares from which a friendly piece of that type attacks the opponent king.
+    Square friendlyKingSquare;
+    Square opponentKingSquare;
+} CheckInfo;
+
+extern void CheckInfoInitialize(CheckInfo * checkInfo, const Board * board);
+// Checks whether a pseudo-legal move leaves the friendly king safe.
+extern bool IsMoveLegal(const Board * board, const CheckInfo * checkInfo, Move move);
+// Checks whether a legal move puts the opponent king in check.
+extern bool MoveGivesCheck(const Board * board, const CheckInfo * checkInfo, Move move);
+
+// Squares attacked by one player, per attacking piece type and combined. Computed once per node, so that move ordering
+// (and anything else which needs to know whether a square is safe) can test a square with a single AND.
+typedef struct
+{
+    EncodedSquare byPiece[NUM_PIECE_TYPES + 1]; // Indexed by PieceType; squares attacked by the player's pieces of that type.
+    EncodedSquare all; // Union of all of the above.
+} AttackMap;
+
+extern void AttackMapInitialize(AttackMap * attackMap, const Board * board, Player player);
+
 extern bool KingIsAttacked(const Board * board, Player playerOfKing);
 extern bool IsCheckmate(const Board * board);
 extern bool IsStalemate(const Board * board);
 extern bool HasMoves(const Board * board, Player player);
 extern uint8_t GetValidMoves(const Board * board, Move * moves);
 extern uint8_t GetValidCaptures(const Board * board, Move * moves);
+extern uint8_t GetEvasions(const Board * board, Move * moves);
 extern uint8_t GetPseudoLegalMoves(const Board * board, Move * moves);
 extern uint8_t GetPseudoLegalCaptures(const Board * board, Move * moves);
 extern bool IsMoveValid(const Board * board, Move move);
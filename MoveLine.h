@@ -4,6 +4,8 @@
 #include "Intrinsics.h"
 #include "Move.h"
 
+#include <string.h>
+
 #define MAX_LINE_DEPTH 64
 
 typedef struct
@@ -18,4 +20,14 @@ static FORCE_INLINE void MoveLineInit(MoveLine * line)
     line->length = 0;
 }
 
+// Sets the line to the move followed by the rest of the line. Quiescence search can go deeper than a line holds, so
+// anything past MAX_LINE_DEPTH moves is cut off.
+static FORCE_INLINE void MoveLinePrepend(MoveLine * line, Move move, const MoveLine * rest)
+{
+    int length = (rest->length < MAX_LINE_DEPTH - 1) ? rest->length : MAX_LINE_DEPTH - 1;
+    line->moves[0] = move;
+    memcpy(line->moves + 1, rest->moves, length * sizeof(Move));
+    line->length = length + 1;
+}
+
 #endif // MOVE_LINE_H_
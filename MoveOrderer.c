@@ -10,22 +10,57 @@
 
 #define MOVE_ORDERER_PRE_SORT 0
 
-void MoveOrdererInitialize(MoveOrderer * moveOrderer, const Board * board, Move * moves, int32_t * approxScores, uint8_t numMoves, int32_t linePly, const MoveLine * bestLinePrev, const KillerMoves * killerMoves, Move ttMove)
+// Scores reserved for moves which must come first (or last); ordinary scores are clamped to the range in between.
+#define MOVE_SCORE_TT_MOVE INT16_MAX
+#define MOVE_SCORE_BEST_LINE_MOVE (INT16_MAX - 1)
+#define MOVE_SCORE_MAX (INT16_MAX - 2)
+#define MOVE_SCORE_MIN (INT16_MIN + 1)
+#define MOVE_SCORE_KING_CAPTURE INT16_MIN
+
+static FORCE_INLINE uint32_t MakeSortKey(int32_t score, Move move)
 {
-    const uint64_t * opponentPieceTables;
-    const uint64_t * friendlyPawnAttacks;
-    if (board->playerToMove == White)
-    {
-        opponentPieceTables = board->blackPieceTables;
-        friendlyPawnAttacks = s_pawnAttackBitboardWhite;
-    }
-    else
+    return ((uint32_t) (score - INT16_MIN) << 16) | MoveEncode(move);
+}
+
+static FORCE_INLINE uint32_t MakeClampedSortKey(int32_t score, Move move)
+{
+    if (score > MOVE_SCORE_MAX)
+        score = MOVE_SCORE_MAX;
+    else if (score < MOVE_SCORE_MIN)
+        score = MOVE_SCORE_MIN;
+    return MakeSortKey(score, move);
+}
+
+static FORCE_INLINE Move SortKeyGetMove(const Board * board, uint32_t key)
+{
+    Move move = MoveDecode((EncodedMove) key);
+    move.piece = BoardGetPieceAtSquare(board, move.from);
+    return move;
+}
+
+// Selection step: moves the highest key at or after the given index to that index.
+// Only the score part is compared, so ties keep the first move in generation order. Breaking ties by the move
+// encoding instead searches about 50% more nodes.
+static FORCE_INLINE void SelectBest(uint32_t * keys, uint8_t index, uint8_t numMoves)
+{
+    uint8_t swapPoint = index;
+    uint32_t highestKey = keys[index];
+    for (uint8_t i = index + 1; i < numMoves; ++i)
     {
-        opponentPieceTables = board->whitePieceTables;
-        friendlyPawnAttacks = s_pawnAttackBitboardBlack;
+        if (keys[i] > (highestKey | 0xFFFF))
+        {
+            swapPoint = i;
+            highestKey = keys[i];
+        }
     }
 
-    unsigned long long pieceCount = intrinsic_popcnt64(board->allPieceTables);
+    keys[swapPoint] = keys[index];
+    keys[index] = highestKey;
+}
+
+void MoveOrdererInitialize(MoveOrderer * moveOrderer, const Board * board, const Move * moves, uint32_t * keys, uint8_t numMoves, const AttackMap * opponentAttacks, int32_t linePly, const MoveLine * bestLinePrev, const KillerMoves * killerMoves, Move ttMove)
+{
+    unsigned long long pieceCount = intrinsic_popcnt64(BoardGetOccupancy(board));
     const int32_t * pieceValueTable = (pieceCount > 10) ? PieceValuesMillipawnsMidGame : PieceValuesMillipawnsEndGame;
 
     // Order moves by a very simple approximate method of determining high vs. low value, to assist in alpha-beta pruning.
@@ -33,19 +68,18 @@ void MoveOrdererInitialize(MoveOrderer * moveOrderer, const Board * board, Move
     for (uint8_t i = 0; i < numMoves; ++i)
     {
         Square square = moves[i].to;
-        EncodedSquare encoded = SquareEncode(square);
         PieceType piece = moves[i].piece;
 
         // Start with score equal just to difference in static position score.
         //int32_t pieceToSquareValue = GetPieceValue(midGameProgressionScalar, endGameProgressionScalar, playerToMove, piece, square);
-        //approxScores[i] = pieceToSquareValue - GetPieceValue(midGameProgressionScalar, endGameProgressionScalar, playerToMove, piece, moves[i].from);
+        //score = pieceToSquareValue - GetPieceValue(midGameProgressionScalar, endGameProgressionScalar, playerToMove, piece, moves[i].from);
         int32_t pieceToSquareValue = pieceValueTable[piece];
-        approxScores[i] = 0;
+        int32_t score = 0;
 
         // If present the move from the transposition table should come first. This is the single greatest benefit to move ordering.
         if (MoveEquals(ttMove, moves[i]))
         {
-            approxScores[i] += 100000000;
+            keys[i] = MakeSortKey(MOVE_SCORE_TT_MOVE, moves[i]);
             continue; // No point to doing the rest, it won't matter (nothing else can lower the score enough to make a difference).
         }
 
@@ -53,33 +87,25 @@ void MoveOrdererInitialize(MoveOrderer * moveOrderer, const Board * board, Move
         // then give this move a score boost to make it come first.
         if (bestLinePrev != NULL && bestLinePrev->length > linePly && MoveEquals(bestLinePrev->moves[linePly], moves[i]))
         {
-            approxScores[i] += 1000000;
+            keys[i] = MakeSortKey(MOVE_SCORE_BEST_LINE_MOVE, moves[i]);
             continue; // No point to doing the rest, it won't matter (nothing else can lower the score enough to make a difference).
         }
 
-        // Capturing a piece is good.
-        if (opponentPieceTables[PIECE_TABLE_COMBINED] & encoded)
+        // Capturing a piece is good. Pseudo-legal moves never land on a friendly piece, so any piece found here
+        // belongs to the opponent.
+        PieceType capturedPiece = BoardGetPieceAtSquare(board, square);
+        if (capturedPiece != None)
         {
-            if (opponentPieceTables[PIECE_TABLE_PAWNS] & encoded)
-                approxScores[i] += pieceValueTable[Pawn];
-            else if (opponentPieceTables[PIECE_TABLE_KNIGHTS] & encoded)
-                approxScores[i] += pieceValueTable[Knight];
-            else if (opponentPieceTables[PIECE_TABLE_BISHOPS_QUEENS] & encoded)
-            {
-                if (opponentPieceTables[PIECE_TABLE_ROOKS_QUEENS] & encoded)
-                    approxScores[i] += pieceValueTable[Queen];
-                else
-                    approxScores[i] += pieceValueTable[Bishop];
-            }
-            else if (opponentPieceTables[PIECE_TABLE_ROOKS_QUEENS] & encoded)
-                approxScores[i] += pieceValueTable[Rook];
-            else
+            if (capturedPiece == King)
             {
                 // Because we use pseudo-legal moves, this is technically possible (invalid move leads to capture of a king).
                 // In this case, reduce the score by a lot, so it should get pruned out.
                 assert(square == (board->playerToMove == White ? board->blackKingSquare : board->whiteKingSquare));
-                approxScores[i] -= 100000000;
+                keys[i] = MakeSortKey(MOVE_SCORE_KING_CAPTURE, moves[i]);
+                continue;
             }
+
+            score += pieceValueTable[capturedPiece];
         }
         else
         {
@@ -87,7 +113,7 @@ void MoveOrdererInitialize(MoveOrderer * moveOrderer, const Board * board, Move
             {
                 // Give killer moves a little bump: we should be able to prune from these.
                 // These are set to be slightly more valuable than a pawn.
-                approxScores[i] += 1500;
+                score += 1500;
             }
         }
 
@@ -95,54 +121,29 @@ void MoveOrdererInitialize(MoveOrderer * moveOrderer, const Board * board, Move
         if (piece == Pawn)
         {
             if (moves[i].promotion != None)
-                approxScores[i] += pieceValueTable[moves[i].promotion] - pieceToSquareValue;
+                score += pieceValueTable[moves[i].promotion] - pieceToSquareValue;
         }
 
         // Penalize moving pieces to targettable locations.
-        if ((GetPawnCaptureMoves(friendlyPawnAttacks, square) & opponentPieceTables[PIECE_TABLE_PAWNS]) ||
-            (GetKnightMoves(square) & opponentPieceTables[PIECE_TABLE_KNIGHTS]) ||
-            (GetBishopMoves(board->allPieceTables, square) & opponentPieceTables[PIECE_TABLE_BISHOPS_QUEENS]) ||
-            (GetRookMoves(board->allPieceTables, square) & opponentPieceTables[PIECE_TABLE_ROOKS_QUEENS]) ||
-            (GetKingMoves(square) & SquareEncode(board->playerToMove == White ? board->blackKingSquare : board->whiteKingSquare)))
+        if (opponentAttacks->all & SquareEncode(square))
         {
             // Subtract off the piece's value itself. This will cause prioritization of capturing
             // high value pieces with low value pieces (MVV/LVA).
-            approxScores[i] -= pieceToSquareValue;
+            score -= pieceToSquareValue;
         }
+
+        keys[i] = MakeClampedSortKey(score, moves[i]);
     }
 
 #if MOVE_ORDERER_PRE_SORT
     // Simple sort based on approximate score.
     // We assume the number of moves is generally low enough that we do a selection sort instead of a merge sort or quick sort.
-    // This sort is done in-place with a minimal amount of swapping.
     for (uint8_t i = 0; i < numMoves; ++i)
-    {
-        uint8_t swapPoint = i;
-        int32_t highestScore = approxScores[i];
-        for (uint8_t j = i + 1; j < numMoves; ++j)
-        {
-            if (approxScores[j] > highestScore)
-            {
-                swapPoint = j;
-                highestScore = approxScores[j];
-            }
-        }
-
-        if (swapPoint != i)
-        {
-            int32_t x = approxScores[i];
-            approxScores[i] = approxScores[swapPoint];
-            approxScores[swapPoint] = x;
-
-            Move m = moves[i];
-            moves[i] = moves[swapPoint];
-            moves[swapPoint] = m;
-        }
-    }
+        SelectBest(keys, i, numMoves);
 #endif
 
-    moveOrderer->moves = moves;
-    moveOrderer->approxScores = approxScores;
+    moveOrderer->board = board;
+    moveOrderer->keys = keys;
     moveOrderer->numMoves = numMoves;
     moveOrderer->curIndex = 0;
 }
@@ -158,32 +159,11 @@ bool MoveOrdererGetNextMove(MoveOrderer * moveOrderer, Move * move)
         return false;
 
 #if !MOVE_ORDERER_PRE_SORT
-    // Start at the current index, which is the first candidate move, and iterate to the end, checking for the best score.
-    uint8_t swapPoint = moveOrderer->curIndex;
-    int32_t highestScore = moveOrderer->approxScores[moveOrderer->curIndex];
-    for (uint8_t i = moveOrderer->curIndex + 1; i < moveOrderer->numMoves; ++i)
-    {
-        if (moveOrderer->approxScores[i] > highestScore)
-        {
-            swapPoint = i;
-            highestScore = moveOrderer->approxScores[i];
-        }
-    }
-
     // Shuffle the best move to the front, and then advance curIndex so we don't iterate over it again.
-    if (swapPoint != moveOrderer->curIndex)
-    {
-        int32_t x = moveOrderer->approxScores[moveOrderer->curIndex];
-        moveOrderer->approxScores[moveOrderer->curIndex] = moveOrderer->approxScores[swapPoint];
-        moveOrderer->approxScores[swapPoint] = x;
-
-        Move m = moveOrderer->moves[moveOrderer->curIndex];
-        moveOrderer->moves[moveOrderer->curIndex] = moveOrderer->moves[swapPoint];
-        moveOrderer->moves[swapPoint] = m;
-    }
+    SelectBest(moveOrderer->keys, moveOrderer->curIndex, moveOrderer->numMoves);
 #endif
 
-    *move = moveOrderer->moves[moveOrderer->curIndex];
+    *move = SortKeyGetMove(moveOrderer->board, moveOrderer->keys[moveOrderer->curIndex]);
     moveOrderer->curIndex++;
     return true;
 }
@@ -192,39 +172,15 @@ void MoveOrdererPrint(const MoveOrderer * moveOrderer)
 {
 #if !MOVE_ORDERER_PRE_SORT
     // Simple sort based on approximate score.
-    // We assume the number of moves is generally low enough that we do a selection sort instead of a merge sort or quick sort.
-    // This sort is done in-place with a minimal amount of swapping.
     for (uint8_t i = 0; i < moveOrderer->numMoves; ++i)
-    {
-        uint8_t swapPoint = i;
-        int32_t highestScore = moveOrderer->approxScores[i];
-        for (uint8_t j = i + 1; j < moveOrderer->numMoves; ++j)
-        {
-            if (moveOrderer->approxScores[j] > highestScore)
-            {
-                swapPoint = j;
-                highestScore = moveOrderer->approxScores[j];
-            }
-        }
-
-        if (swapPoint != i)
-        {
-            int32_t x = moveOrderer->approxScores[i];
-            moveOrderer->approxScores[i] = moveOrderer->approxScores[swapPoint];
-            moveOrderer->approxScores[swapPoint] = x;
-
-            Move m = moveOrderer->moves[i];
-            moveOrderer->moves[i] = moveOrderer->moves[swapPoint];
-            moveOrderer->moves[swapPoint] = m;
-        }
-    }
+        SelectBest(moveOrderer->keys, i, moveOrderer->numMoves);
 #endif
 
     char moveStr[6]; // Max 5 chars plus extra character for null-termination
     for (uint8_t i = 0; i < moveOrderer->numMoves; ++i)
     {
         memset(moveStr, 0, sizeof(moveStr));
-        if (0 != MoveToString(moveOrderer->moves[i], moveStr, sizeof(moveStr) - 1))
+        if (0 != MoveToString(SortKeyGetMove(moveOrderer->board, moveOrderer->keys[i]), moveStr, sizeof(moveStr) - 1))
         {
             if (i > 0)
                 putc(' ', stdout);
@@ -3,21 +3,25 @@
 
 #include "Board.h"
 #include "KillerMove.h"
+#include "MoveGeneration.h"
 #include "MoveLine.h"
 #include "Player.h"
 
 #include <stdbool.h>
 #include <stdint.h>
 
+// Each move is stored as a single 32 bit sort key: the approximate score in the upper 16 bits (biased so that
+// unsigned order is score order) and the EncodedMove in the lower 16 bits. Picking the next move is a single max scan
+// over one array, and the piece type is recovered from the board when the move is returned.
 typedef struct
 {
-    Move * moves;
-    int32_t * approxScores;
+    const Board * board;
+    uint32_t * keys;
     uint8_t numMoves;
     uint8_t curIndex;
 } MoveOrderer;
 
-extern void MoveOrdererInitialize(MoveOrderer * moveOrderer, const Board * board, Move * moves, int32_t * approxScores, uint8_t numMoves, int32_t linePly, const MoveLine * bestLinePrev, const KillerMoves * killerMoves, Move ttMove);
+extern void MoveOrdererInitialize(MoveOrderer * moveOrderer, const Board * board, const Move * moves, uint32_t * keys, uint8_t numMoves, const AttackMap * opponentAttacks, int32_t linePly, const MoveLine * bestLinePrev, const KillerMoves * killerMoves, Move ttMove);
 extern bool MoveOrdererGetNextMove(MoveOrderer * moveOrderer, Move * move);
 extern void MoveOrdererPrint(const MoveOrderer * moveOrderer);
 
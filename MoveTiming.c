@@ -0,0 +1,174 @@
+#include "MoveTiming.h"
+#include "Logger.h"
+#include "Mutex.h"
+#include "Options.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+static const uint32_t s_bucketBounds[MOVE_TIMING_NUM_BUCKETS - 1] = MOVE_TIMING_BUCKET_BOUNDS;
+
+static MoveTimingStats s_stats;
+static Mutex s_mutex;
+
+typedef void (*MoveTimingOutput)(const char * line);
+
+static int GetBucket(uint64_t microseconds)
+{
+    for (int bucket = 0; bucket < MOVE_TIMING_NUM_BUCKETS - 1; ++bucket)
+    {
+        if (microseconds <= (uint64_t)s_bucketBounds[bucket] * 1000)
+            return bucket;
+    }
+    return MOVE_TIMING_NUM_BUCKETS - 1;
+}
+
+bool MoveTimingInitialize()
+{
+    memset(&s_stats, 0, sizeof(s_stats));
+    return MutexInitialize(&s_mutex);
+}
+
+void MoveTimingDestroy()
+{
+    MutexDestroy(&s_mutex);
+}
+
+void MoveTimingGetLimits(uint32_t moveTime, uint32_t totalTime, uint32_t increment, uint32_t movesToGo, uint32_t moveOverhead,
+                         uint32_t * softLimitMs, uint32_t * hardLimitMs)
+{
+    *softLimitMs = MOVE_TIMING_NO_LIMIT;
+    *hardLimitMs = MOVE_TIMING_NO_LIMIT;
+
+    uint64_t budget;
+    if (moveTime != MOVE_TIMING_NO_LIMIT)
+    {
+        budget = moveTime;
+    }
+    else if (totalTime != MOVE_TIMING_NO_LIMIT)
+    {
+        // Have enough time remaining for at most 40 moves. As time decreases, this will slowly cause moves to speed up.
+        if (movesToGo == 0 || movesToGo > 40)
+            movesToGo = 40;
+        budget = totalTime / movesToGo;
+        // Include increment if present.
+        if (increment != MOVE_TIMING_NO_LIMIT)
+            budget += increment;
+    }
+    else
+    {
+        return;
+    }
+
+    // Subtract off any latency time between the engine and the GUI. Close to the flag, the overhead can be more than
+    // the whole budget; the search still needs some time to produce a move.
+    uint64_t hardLimit = (budget > (uint64_t)moveOverhead + MOVE_TIMING_MIN_LIMIT) ? budget - moveOverhead : MOVE_TIMING_MIN_LIMIT;
+    if (hardLimit >= MOVE_TIMING_NO_LIMIT)
+        hardLimit = MOVE_TIMING_NO_LIMIT - 1;
+    *hardLimitMs = (uint32_t)hardLimit;
+
+    // A fixed move time may all be used. Otherwise, set optimal time usage to be 75% of the maximum time. This math
+    // does the division first intentionally, to be conservative (value will be rounded down slightly).
+    *softLimitMs = (moveTime != MOVE_TIMING_NO_LIMIT) ? *hardLimitMs : (*hardLimitMs / 4) * 3;
+}
+
+void MoveTimingRecord(uint64_t latencyMicroseconds, uint32_t softLimitMs, uint32_t hardLimitMs)
+{
+    uint64_t overrunMicroseconds = 0;
+    bool timed = (hardLimitMs != MOVE_TIMING_NO_LIMIT);
+    if (timed && latencyMicroseconds > (uint64_t)hardLimitMs * 1000)
+        overrunMicroseconds = latencyMicroseconds - (uint64_t)hardLimitMs * 1000;
+
+    MutexLock(&s_mutex);
+
+    s_stats.moves++;
+    s_stats.totalMicroseconds += latencyMicroseconds;
+    if (latencyMicroseconds > s_stats.maxMicroseconds)
+        s_stats.maxMicroseconds = latencyMicroseconds;
+    s_stats.latency[GetBucket(latencyMicroseconds)]++;
+
+    if (timed)
+    {
+        s_stats.timedMoves++;
+        if (softLimitMs != MOVE_TIMING_NO_LIMIT && latencyMicroseconds > (uint64_t)softLimitMs * 1000)
+            s_stats.overSoftLimit++;
+        if (overrunMicroseconds > 0)
+        {
+            s_stats.overHardLimit++;
+            s_stats.overrun[GetBucket(overrunMicroseconds)]++;
+            if (overrunMicroseconds > s_stats.maxOverrunMicroseconds)
+                s_stats.maxOverrunMicroseconds = overrunMicroseconds;
+        }
+    }
+
+    MutexUnlock(&s_mutex);
+}
+
+void MoveTimingGetStats(MoveTimingStats * stats)
+{
+    MutexLock(&s_mutex);
+    *stats = s_stats;
+    MutexUnlock(&s_mutex);
+}
+
+void MoveTimingClear()
+{
+    MutexLock(&s_mutex);
+    memset(&s_stats, 0, sizeof(s_stats));
+    MutexUnlock(&s_mutex);
+}
+
+static void FormatHistogram(char * str, size_t size, const char * name, const uint64_t * buckets)
+{
+    size_t length = (size_t)snprintf(str, size, "%s", name);
+    for (int bucket = 0; bucket < MOVE_TIMING_NUM_BUCKETS && length < size; ++bucket)
+    {
+        if (bucket < MOVE_TIMING_NUM_BUCKETS - 1)
+            length += (size_t)snprintf(str + length, size - length, " <=%" PRIu32 "ms:%" PRIu64, s_bucketBounds[bucket], buckets[bucket]);
+        else
+            length += (size_t)snprintf(str + length, size - length, " >%" PRIu32 "ms:%" PRIu64, s_bucketBounds[bucket - 1], buckets[bucket]);
+    }
+}
+
+static void MoveTimingOutputStats(MoveTimingOutput output)
+{
+    MoveTimingStats stats;
+    MoveTimingGetStats(&stats);
+
+    char str[512];
+    snprintf(str, sizeof(str), "Move timing: moves %" PRIu64 " average %.1f ms max %.1f ms moveoverhead %" PRIu32 " ms",
+             stats.moves,
+             stats.moves ? stats.totalMicroseconds / 1000.0 / stats.moves : 0.0,
+             stats.maxMicroseconds / 1000.0,
+             g_optionMoveOverhead);
+    output(str);
+
+    snprintf(str, sizeof(str), "Move timing: timed %" PRIu64 " oversoft %" PRIu64 " overhard %" PRIu64 " maxoverrun %.1f ms",
+             stats.timedMoves,
+             stats.overSoftLimit,
+             stats.overHardLimit,
+             stats.maxOverrunMicroseconds / 1000.0);
+    output(str);
+
+    FormatHistogram(str, sizeof(str), "Move timing: latency", stats.latency);
+    output(str);
+    FormatHistogram(str, sizeof(str), "Move timing: overrun", stats.overrun);
+    output(str);
+}
+
+static void PrintLine(const char * line)
+{
+    printf("info string %s\n", line);
+}
+
+void MoveTimingPrint()
+{
+    MoveTimingOutputStats(&PrintLine);
+    fflush(stdout);
+}
+
+void MoveTimingLog()
+{
+    MoveTimingOutputStats(&LoggerLogLine);
+}
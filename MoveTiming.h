@@ -0,0 +1,57 @@
+#ifndef MOVE_TIMING_H_
+#define MOVE_TIMING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Session statistics of how long each "go" took until "bestmove" was written, against the time it was given. Used to
+// tune the move overhead option and to catch timing regressions.
+
+// Upper bounds, in milliseconds, of the histogram buckets; the last bucket holds everything above the last bound.
+#define MOVE_TIMING_BUCKET_BOUNDS { 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000 }
+#define MOVE_TIMING_NUM_BUCKETS 14
+
+// Time limit of a search without one, e.g. "go depth" or "go infinite".
+#define MOVE_TIMING_NO_LIMIT 0xFFFFFFFF
+
+// Least time, in milliseconds, a move is given however little is left once the move overhead is taken off.
+#define MOVE_TIMING_MIN_LIMIT 10
+
+typedef struct
+{
+    uint64_t moves;               // Number of "go" commands answered with a best move.
+    uint64_t totalMicroseconds;   // Latency from receiving "go" to writing "bestmove", summed and at most.
+    uint64_t maxMicroseconds;
+    uint64_t latency[MOVE_TIMING_NUM_BUCKETS];
+
+    // Only the moves which had a hard limit count towards the overrun statistics.
+    uint64_t timedMoves;
+    uint64_t overSoftLimit;       // Moves which took longer than the soft (optimal) limit.
+    uint64_t overHardLimit;       // Moves which took longer than the hard limit, at which the search is stopped.
+    uint64_t maxOverrunMicroseconds;
+    uint64_t overrun[MOVE_TIMING_NUM_BUCKETS]; // Time past the hard limit, of the moves over it.
+} MoveTimingStats;
+
+extern bool MoveTimingInitialize();
+extern void MoveTimingDestroy();
+
+// Computes the soft (optimal) and hard limits of a "go" from its parameters, all in milliseconds. Parameters which
+// were not given are MOVE_TIMING_NO_LIMIT, movesToGo 0; without a move time or remaining time both limits are
+// MOVE_TIMING_NO_LIMIT. The move overhead is taken off the budget, the hard limit is at least MOVE_TIMING_MIN_LIMIT
+// and the soft limit never exceeds the hard limit.
+extern void MoveTimingGetLimits(uint32_t moveTime, uint32_t totalTime, uint32_t increment, uint32_t movesToGo, uint32_t moveOverhead,
+                                uint32_t * softLimitMs, uint32_t * hardLimitMs);
+
+// Records one answered "go". The limits are in milliseconds, or MOVE_TIMING_NO_LIMIT. Safe to call from any thread.
+extern void MoveTimingRecord(uint64_t latencyMicroseconds, uint32_t softLimitMs, uint32_t hardLimitMs);
+
+extern void MoveTimingGetStats(MoveTimingStats * stats);
+extern void MoveTimingClear();
+
+// Prints the statistics as info strings.
+extern void MoveTimingPrint();
+
+// Writes the statistics to the log.
+extern void MoveTimingLog();
+
+#endif // MOVE_TIMING_H_
@@ -703,7 +703,7 @@ static const char * PieceToString(PieceType piece)
 
 int main(int argc, char ** argv)
 {
-    int result = Init(NULL);
+    int result = Init();
     if (result != 0)
         return result;
 
@@ -0,0 +1,284 @@
+#include "FEN.h"
+#include "Move.h"
+#include "MoveGeneration.h"
+#include "Mutex.h"
+#include "Perft.h"
+#include "StaticAssert.h"
+#include "Thread.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Tasks only hold the two moves leading to their position; the board is rebuilt by the worker, since Boards need
+// cache line alignment which malloc does not guarantee.
+typedef struct
+{
+    uint64_t nodes;
+    Move reply;
+    uint8_t rootMove; // Index of the root move this task counts towards.
+} PerftTask;
+
+typedef struct
+{
+    const Board * board;
+    const Move * rootMoves;
+    PerftTask * tasks;
+    uint32_t numTasks;
+    uint32_t nextTask;
+    uint32_t depth; // Remaining depth below each task's board.
+    Mutex mutex;
+} PerftContext;
+
+// Perft hash table entry. The hash is stored XORed with the data, so an entry which is torn by two threads writing it
+// at the same time fails the hash check instead of returning a wrong count; this keeps the table lockless.
+typedef struct
+{
+    uint64_t hashXorData;
+    uint64_t data; // [0:7]: Remaining depth. [8:63]: Leaf count.
+} PerftHashEntry;
+
+#define PERFT_HASH_BUCKET_SIZE 4
+
+// One cache line; the entry with the lowest depth in the bucket is replaced.
+typedef struct
+{
+    PerftHashEntry entries[PERFT_HASH_BUCKET_SIZE];
+} PerftHashBucket;
+
+STATIC_ASSERT(sizeof(PerftHashBucket) == 64, "PerftHashBucket should fill exactly one cache line");
+
+static volatile PerftHashBucket * s_perftHash = NULL;
+static size_t s_perftHashNumBucketsMinusOne = 0;
+static size_t s_perftHashSizeMB = PERFT_HASH_DEFAULT_SIZE_MB;
+
+bool PerftSetHashSize(size_t sizeMB)
+{
+    if (sizeMB > 0x100000)
+        return false;
+
+    PerftDestroy();
+    s_perftHashSizeMB = sizeMB;
+    return true;
+}
+
+void PerftDestroy()
+{
+    free((void *) s_perftHash);
+    s_perftHash = NULL;
+    s_perftHashNumBucketsMinusOne = 0;
+}
+
+static bool PerftHashAllocate()
+{
+    if (s_perftHash != NULL || s_perftHashSizeMB == 0)
+        return true;
+
+    // Round down to a power of 2 so the bucket index is a mask.
+    size_t numBuckets = ((size_t) s_perftHashSizeMB << 20) / sizeof(PerftHashBucket);
+    while (intrinsic_blsr64(numBuckets) != 0)
+        numBuckets = intrinsic_blsr64(numBuckets);
+
+    s_perftHash = (volatile PerftHashBucket *) calloc(numBuckets, sizeof(PerftHashBucket));
+    if (s_perftHash == NULL)
+        return false;
+    s_perftHashNumBucketsMinusOne = numBuckets - 1;
+    return true;
+}
+
+static FORCE_INLINE bool PerftHashLookup(uint64_t hash, uint32_t depth, uint64_t * nodes)
+{
+    volatile PerftHashEntry * entries = s_perftHash[hash & s_perftHashNumBucketsMinusOne].entries;
+    for (int i = 0; i < PERFT_HASH_BUCKET_SIZE; ++i)
+    {
+        uint64_t data = entries[i].data;
+        if ((entries[i].hashXorData ^ data) == hash && (data & 0xFF) == depth)
+        {
+            *nodes = data >> 8;
+            return true;
+        }
+    }
+    return false;
+}
+
+static FORCE_INLINE void PerftHashStore(uint64_t hash, uint32_t depth, uint64_t nodes)
+{
+    volatile PerftHashEntry * entries = s_perftHash[hash & s_perftHashNumBucketsMinusOne].entries;
+    int replace = 0;
+    for (int i = 1; i < PERFT_HASH_BUCKET_SIZE; ++i)
+    {
+        if ((entries[i].data & 0xFF) < (entries[replace].data & 0xFF))
+            replace = i;
+    }
+
+    uint64_t data = (nodes << 8) | depth;
+    entries[replace].hashXorData = hash ^ data;
+    entries[replace].data = data;
+}
+
+static uint64_t CountLeaves(const Board * board, uint32_t depth)
+{
+    if (depth == 0)
+        return 1;
+
+    // Depth 1 is not hashed; bulk counting it is cheaper than a probe.
+    uint64_t nodes = 0;
+    bool hashed = (s_perftHash != NULL && depth > 1);
+    if (hashed && PerftHashLookup(board->hash, depth, &nodes))
+        return nodes;
+
+    // The move buffer lives on the stack, so every thread (and ply) has its own.
+    Move moves[256];
+    uint8_t numMoves = GetValidMoves(board, moves);
+
+    // Bulk counting: the leaves are exactly the legal moves, no need to make them.
+    if (depth == 1)
+        return numMoves;
+
+    Board nextBoard;
+    for (uint8_t i = 0; i < numMoves; ++i)
+    {
+        nextBoard = *board;
+        MakeMove(&nextBoard, moves[i]);
+        nodes += CountLeaves(&nextBoard, depth - 1);
+    }
+
+    if (hashed)
+        PerftHashStore(board->hash, depth, nodes);
+    return nodes;
+}
+
+#ifdef __GNUC__
+static void * PerftWorker(void * param)
+#else
+static DWORD PerftWorker(void * param)
+#endif
+{
+    PerftContext * context = (PerftContext *) param;
+    while (true)
+    {
+        MutexLock(&context->mutex);
+        uint32_t index = context->nextTask;
+        if (index < context->numTasks)
+            context->nextTask++;
+        MutexUnlock(&context->mutex);
+
+        if (index >= context->numTasks)
+            break;
+
+        PerftTask * task = &context->tasks[index];
+        Board board = *context->board;
+        MakeMove(&board, context->rootMoves[task->rootMove]);
+        MakeMove(&board, task->reply);
+        task->nodes = CountLeaves(&board, context->depth);
+    }
+    return 0;
+}
+
+bool Perft(const Board * board, uint32_t depth, uint32_t numThreads, bool divide, uint64_t * nodes)
+{
+    if (!PerftHashAllocate())
+        return false;
+
+    Move rootMoves[256];
+    uint64_t rootNodes[256];
+    uint8_t numRootMoves = GetValidMoves(board, rootMoves);
+    memset(rootNodes, 0, sizeof(rootNodes));
+
+    if (depth == 0)
+    {
+        *nodes = 1;
+        return true;
+    }
+
+    Board nextBoard;
+    if (depth <= 2)
+    {
+        // Too little work to be worth splitting.
+        for (uint8_t i = 0; i < numRootMoves; ++i)
+        {
+            nextBoard = *board;
+            MakeMove(&nextBoard, rootMoves[i]);
+            rootNodes[i] = CountLeaves(&nextBoard, depth - 1);
+        }
+    }
+    else
+    {
+        PerftContext context;
+        context.board = board;
+        context.rootMoves = rootMoves;
+        context.numTasks = 0;
+        context.nextTask = 0;
+        context.depth = depth - 2;
+
+        // One task per move at ply 2; the root moves alone are too few (and too uneven) to keep many threads busy.
+        context.tasks = (PerftTask *) malloc(sizeof(PerftTask) * numRootMoves * 256);
+        if (context.tasks == NULL)
+            return false;
+
+        Move replies[256];
+        for (uint8_t i = 0; i < numRootMoves; ++i)
+        {
+            nextBoard = *board;
+            MakeMove(&nextBoard, rootMoves[i]);
+            uint8_t numReplies = GetValidMoves(&nextBoard, replies);
+            for (uint8_t k = 0; k < numReplies; ++k)
+            {
+                PerftTask * task = &context.tasks[context.numTasks++];
+                task->nodes = 0;
+                task->reply = replies[k];
+                task->rootMove = i;
+            }
+        }
+
+        if (!MutexInitialize(&context.mutex))
+        {
+            free(context.tasks);
+            return false;
+        }
+
+        if (numThreads == 0)
+            numThreads = 1;
+        if (numThreads > context.numTasks)
+            numThreads = context.numTasks;
+
+        ThreadHandle * threads = (ThreadHandle *) malloc(sizeof(ThreadHandle) * numThreads);
+        uint32_t numStarted = 0;
+        if (threads != NULL)
+        {
+            while (numStarted < numThreads && ThreadStart(&threads[numStarted], &PerftWorker, &context))
+                numStarted++;
+        }
+
+        // The workers take tasks until there are none left, so this thread only has to help out if none could be started.
+        if (numStarted == 0)
+            PerftWorker(&context);
+
+        for (uint32_t i = 0; i < numStarted; ++i)
+            ThreadJoin(threads[i]);
+
+        for (uint32_t i = 0; i < context.numTasks; ++i)
+            rootNodes[context.tasks[i].rootMove] += context.tasks[i].nodes;
+
+        free(threads);
+        MutexDestroy(&context.mutex);
+        free(context.tasks);
+    }
+
+    uint64_t totalNodes = 0;
+    for (uint8_t i = 0; i < numRootMoves; ++i)
+    {
+        totalNodes += rootNodes[i];
+
+        if (divide)
+        {
+            char moveStr[6]; // Max 5 chars plus extra character for null-termination
+            memset(moveStr, 0, sizeof(moveStr));
+            if (0 != MoveToString(rootMoves[i], moveStr, sizeof(moveStr) - 1))
+                printf("%s: %" PRIu64 "\n", moveStr, rootNodes[i]);
+        }
+    }
+
+    *nodes = totalNodes;
+    return true;
+}
@@ -0,0 +1,23 @@
+#ifndef PERFT_H_
+#define PERFT_H_
+
+#include "Board.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PERFT_HASH_DEFAULT_SIZE_MB 64
+
+// Sets the size of the perft hash table, which caches subtree counts by position and remaining depth. A size of zero
+// disables the table; running with the table disabled verifies that hash collisions don't affect the counts. The
+// table is allocated on the next call to Perft(). Returns false if the size is out of range.
+extern bool PerftSetHashSize(size_t sizeMB);
+extern void PerftDestroy();
+
+// Counts the leaf nodes of the legal move tree of the given depth. The moves at ply 2 are handed out to numThreads
+// worker threads, each with its own move buffers. With divide, the count below each root move is printed as it would
+// be by "go perft" in other engines. Returns false if the work could not be set up.
+extern bool Perft(const Board * board, uint32_t depth, uint32_t numThreads, bool divide, uint64_t * nodes);
+
+#endif // PERFT_H_
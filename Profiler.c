@@ -0,0 +1,66 @@
+#include "Profiler.h"
+#include "Timer.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#if PROFILING
+
+PROFILE_THREAD_LOCAL ProfileCounters g_profileCounters;
+PROFILE_THREAD_LOCAL uint64_t g_profileZoneStart[NUM_PROFILE_ZONES];
+PROFILE_THREAD_LOCAL uint64_t g_profileStartTicks;
+PROFILE_THREAD_LOCAL uint64_t g_profileStartMicroseconds;
+
+static const char * s_zoneNames[NUM_PROFILE_ZONES] =
+{
+    "movegen",
+    "ordering",
+    "eval",
+    "tt",
+    "syzygy",
+    "makemove"
+};
+
+void ProfileReset()
+{
+    ProfileCountersClear(&g_profileCounters);
+    g_profileStartMicroseconds = TimerGetMicroseconds();
+    g_profileStartTicks = ProfileReadTicks();
+}
+
+void ProfileAccumulate(ProfileCounters * counters)
+{
+    for (int zone = 0; zone < NUM_PROFILE_ZONES; ++zone)
+    {
+        counters->ticks[zone] += g_profileCounters.ticks[zone];
+        counters->calls[zone] += g_profileCounters.calls[zone];
+    }
+    counters->totalTicks += ProfileReadTicks() - g_profileStartTicks;
+    counters->totalMicroseconds += TimerGetMicroseconds() - g_profileStartMicroseconds;
+}
+
+void ProfilePrint(const ProfileCounters * counters)
+{
+    if (counters->totalTicks == 0 || counters->totalMicroseconds == 0)
+        return;
+
+    double ticksPerMicrosecond = (double)counters->totalTicks / counters->totalMicroseconds;
+    uint64_t zoneTicks = 0;
+    for (int zone = 0; zone < NUM_PROFILE_ZONES; ++zone)
+    {
+        zoneTicks += counters->ticks[zone];
+        printf("info string profile %-8s %8.1f ms %5.1f%% calls %" PRIu64 " cycles/call %.1f\n",
+               s_zoneNames[zone],
+               counters->ticks[zone] / ticksPerMicrosecond / 1000.0,
+               (100.0 * counters->ticks[zone]) / counters->totalTicks,
+               counters->calls[zone],
+               counters->calls[zone] ? (double)counters->ticks[zone] / counters->calls[zone] : 0.0);
+    }
+
+    uint64_t otherTicks = (counters->totalTicks > zoneTicks) ? counters->totalTicks - zoneTicks : 0;
+    printf("info string profile %-8s %8.1f ms %5.1f%%\n", "other", otherTicks / ticksPerMicrosecond / 1000.0, (100.0 * otherTicks) / counters->totalTicks);
+    printf("info string profile %-8s %8.1f ms (%.0f MHz time stamp counter)\n", "total", counters->totalMicroseconds / 1000.0, ticksPerMicrosecond);
+    fflush(stdout);
+}
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include "Intrinsics.h"
+
+#include <stdint.h>
+#include <string.h>
+
+// Enables the profiling zones. Each zone reads the time stamp counter on entry and exit and adds the difference to a
+// per-thread accumulator, which costs a few dozen cycles per zone; so leave this off except when profiling. When
+// disabled, the zone macros and the functions below compile to nothing.
+#define PROFILING 0
+
+typedef enum
+{
+    ProfileZoneMoveGeneration,
+    ProfileZoneMoveOrdering,
+    ProfileZoneEvaluation,
+    ProfileZoneTranspositionTable,
+    ProfileZoneSyzygy,
+    ProfileZoneMakeMove,
+    NUM_PROFILE_ZONES
+} ProfileZone;
+
+#if PROFILING
+
+#if defined(_MSC_VER)
+#define PROFILE_THREAD_LOCAL __declspec(thread)
+#else
+#define PROFILE_THREAD_LOCAL __thread
+#endif
+
+typedef struct
+{
+    uint64_t ticks[NUM_PROFILE_ZONES];
+    uint64_t calls[NUM_PROFILE_ZONES];
+    // Wall clock and time stamp counter over the whole profiled period, to convert ticks to time and get percentages.
+    uint64_t totalTicks;
+    uint64_t totalMicroseconds;
+} ProfileCounters;
+
+extern PROFILE_THREAD_LOCAL ProfileCounters g_profileCounters;
+extern PROFILE_THREAD_LOCAL uint64_t g_profileZoneStart[NUM_PROFILE_ZONES];
+extern PROFILE_THREAD_LOCAL uint64_t g_profileStartTicks;
+extern PROFILE_THREAD_LOCAL uint64_t g_profileStartMicroseconds;
+
+static FORCE_INLINE uint64_t ProfileReadTicks()
+{
+    return __rdtsc();
+}
+
+// Zones may be entered any number of times in a function, but must not nest within a zone of the same kind.
+#define PROFILE_BEGIN(zone) (g_profileZoneStart[zone] = ProfileReadTicks())
+#define PROFILE_END(zone) \
+    do \
+    { \
+        g_profileCounters.ticks[zone] += ProfileReadTicks() - g_profileZoneStart[zone]; \
+        g_profileCounters.calls[zone]++; \
+    } \
+    while (0)
+
+#else
+
+typedef struct
+{
+    char unused;
+} ProfileCounters;
+
+#define PROFILE_BEGIN(zone)
+#define PROFILE_END(zone)
+
+#endif
+
+static FORCE_INLINE void ProfileCountersClear(ProfileCounters * counters)
+{
+#if PROFILING
+    memset(counters, 0, sizeof(ProfileCounters));
+#else
+    (void)counters;
+#endif
+}
+
+#if PROFILING
+
+// Clears the accumulators of the calling thread and starts a new profiled period.
+extern void ProfileReset();
+
+// Adds the accumulators of the calling thread, over the period since the last ProfileReset, to counters.
+extern void ProfileAccumulate(ProfileCounters * counters);
+
+// Prints the time spent in each zone, and outside of all zones, as info strings.
+extern void ProfilePrint(const ProfileCounters * counters);
+
+#else
+
+static FORCE_INLINE void ProfileReset()
+{
+}
+
+static FORCE_INLINE void ProfileAccumulate(ProfileCounters * counters)
+{
+    (void)counters;
+}
+
+static FORCE_INLINE void ProfilePrint(const ProfileCounters * counters)
+{
+    (void)counters;
+}
+
+#endif
+
+#endif // PROFILER_H_
@@ -1,185 +1,125 @@
 #ifndef REPETITION_H_
 #define REPETITION_H_
 
-#include "Intrinsics.h"
-#include "StaticAssert.h"
+#include "MoveLine.h"
 
 #include <assert.h>
-#include <limits.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
-#define TRANSPOSITION_TABLE_SIZE 256
+// Number of entries kept free on top of the game history for the search path. Search extensions can
+// push the line past MAX_LINE_DEPTH, so leave the same headroom as the move line storage in the search.
+#define REPETITION_STACK_SEARCH_PLY (MAX_LINE_DEPTH * 2)
 
-// This should be large enough to fit a few hash collisions, without blowing up the cache size a bunch.
-// A good number is something that allows a full bucket to fit in a cache line.
-#define REPETITION_TABLE_BUCKET_SIZE 5
+// A repetition needs at least two moves from each side (e.g. a knight moving out and back),
+// so the nearest position which can possibly repeat the current one is four ply back.
+#define REPETITION_MIN_DISTANCE 4
 
-// Extra linked-list node used only when a bucket is fully used up.
-// This is purely needed because we mess around with optimization tricks a lot here.
-// This wouldn't be necessary if we did a pure stack-based implementation.
-struct RepetitionNodeS;
-
-typedef struct RepetitionNodeS
+// Contiguous stack of Zobrist hashes, one entry per ply.
+// The bottom of the stack is the game history (every position played before the root of the search),
+// and the search path is stored on top of it, indexed directly by ply. There is no per-node allocation
+// and no hashing; the scan for a repetition is a short backwards walk over a single array, bounded by the
+// halfmove counter because positions before the last capture or pawn move can never be repeated.
+typedef struct
 {
-    uint64_t hash;
-    struct RepetitionNodeS * next;
-    struct RepetitionNodeS * prev;
-} RepetitionNode;
+    uint64_t * hashes;
+    size_t length; // Number of game history entries.
+    size_t capacity; // Maximum number of game history entries before growing. Search entries are not included.
+} RepetitionStack;
 
-#pragma pack(push, 1)
-typedef struct
+static inline bool RepetitionStackInitialize(RepetitionStack * rs, size_t capacity)
 {
-    uint64_t hashStack[REPETITION_TABLE_BUCKET_SIZE];
-    RepetitionNode * hashListStart;
-    RepetitionNode * hashListEnd;
-    uint8_t stackLength;
-    char padding[7];
-} RepetitionBucket;
-#pragma pack(pop)
+    if (capacity == 0)
+        return false;
 
-STATIC_ASSERT(sizeof(RepetitionBucket) <= 64, "RepetitionBucket struct is too large for a single cache line");
+    rs->hashes = (uint64_t *) malloc((capacity + REPETITION_STACK_SEARCH_PLY) * sizeof(uint64_t));
+    if (rs->hashes == NULL)
+        return false;
+    rs->length = 0;
+    rs->capacity = capacity;
+    return true;
+}
 
-typedef struct
+static inline void RepetitionStackDestroy(RepetitionStack * rs)
 {
-    RepetitionBucket * buckets;
-    // Store value minus one to make lookup and insertion one instruction faster, at expense of making clearing one instruction slower.
-    // Lookup and insertion is MUCH more common, so this is a fair tradeoff.
-    size_t numBucketsMinusOne;
-} RepetitionTable;
+    free(rs->hashes);
+    rs->hashes = NULL;
+    rs->length = 0;
+    rs->capacity = 0;
+}
 
-static inline void RepetitionTableFreeHeapNodes(RepetitionTable * rt);
+static inline void RepetitionStackClear(RepetitionStack * rs)
+{
+    rs->length = 0;
+}
 
-static inline bool RepetitionTableInitialize(RepetitionTable * rt, size_t numBuckets)
+static inline bool RepetitionStackReserve(RepetitionStack * rs, size_t capacity)
 {
-    // Number of buckets must be at least 2^16 and must be a power of 2.
-    // This means the minimum repetition table size is 4MB (2^16 * sizeof(TranspositionBucket)).
-    if (numBuckets < 0x10000 || intrinsic_popcnt64(numBuckets) != 1)
-        return false;
+    if (capacity <= rs->capacity)
+        return true;
 
-    rt->buckets = (RepetitionBucket *) malloc(numBuckets * sizeof(RepetitionBucket));
-    if (rt->buckets == NULL)
+    uint64_t * hashes = (uint64_t *) realloc(rs->hashes, (capacity + REPETITION_STACK_SEARCH_PLY) * sizeof(uint64_t));
+    if (hashes == NULL)
         return false;
-    rt->numBucketsMinusOne = numBuckets - 1;
-    // TODO: Parallelize w/ threads? Stockfish parallelizes this operation.
-    memset(rt->buckets, 0, (rt->numBucketsMinusOne + 1) * sizeof(RepetitionBucket));
+    rs->hashes = hashes;
+    rs->capacity = capacity;
     return true;
 }
 
-// Avoid calling this. This can be slow because it needs to traverse all buckets to clean up heap memory.
-static inline void RepetitionTableClear(RepetitionTable * rt)
+// Appends a position to the game history.
+static inline bool RepetitionStackPush(RepetitionStack * rs, uint64_t hash)
 {
-    RepetitionTableFreeHeapNodes(rt);
-    memset(rt->buckets, 0, (rt->numBucketsMinusOne + 1) * sizeof(RepetitionBucket));
-}
+    if (rs->length == rs->capacity && !RepetitionStackReserve(rs, rs->capacity * 2))
+        return false;
 
-static inline void RepetitionTableDestroy(RepetitionTable * rt)
-{
-    RepetitionTableFreeHeapNodes(rt);
-    free(rt->buckets);
+    rs->hashes[rs->length] = hash;
+    rs->length++;
+    return true;
 }
 
-static inline void RepetitionTableFreeHeapNodes(RepetitionTable * rt)
+static inline void RepetitionStackPop(RepetitionStack * rs)
 {
-    for (size_t i = 0; i <= rt->numBucketsMinusOne; ++i)
-    {
-        RepetitionNode * node = rt->buckets[i].hashListStart;
-        while (node != NULL)
-        {
-            RepetitionNode * thisNode = node;
-            node = node->next;
-            free(thisNode);
-        }
-    }
+    if (rs->length > 0)
+        rs->length--;
 }
 
-static inline bool RepetitionTableContains(RepetitionTable * rt, uint64_t hash)
+static inline bool RepetitionStackCopy(RepetitionStack * dst, const RepetitionStack * src)
 {
-    RepetitionBucket * bucket = &rt->buckets[hash & rt->numBucketsMinusOne];
-    // Check the stack first. Since this is all in one cache line, this should be pretty fast for 99% of cases.
-    for (int i = 0; i < bucket->stackLength; ++i)
-    {
-        if (hash == bucket->hashStack[i])
-            return true;
-    }
-    // Check the linked list extension if present.
-    RepetitionNode * node = bucket->hashListStart;
-    while (node != NULL)
-    {
-        if (node->hash == hash)
-            return true;
-        node = node->next;
-    }
-    return false;
+    if (!RepetitionStackReserve(dst, src->length))
+        return false;
+
+    memcpy(dst->hashes, src->hashes, src->length * sizeof(uint64_t));
+    dst->length = src->length;
+    return true;
 }
 
-static inline void RepetitionTablePush(RepetitionTable * rt, uint64_t hash)
+// Records the position at the given search ply (zero is the root). Entries above this ply are stale
+// and are simply overwritten as the search moves on; they are never read.
+static FORCE_INLINE void RepetitionStackStore(RepetitionStack * rs, int32_t ply, uint64_t hash)
 {
-    RepetitionBucket * bucket = &rt->buckets[hash & rt->numBucketsMinusOne];
-    if (bucket->stackLength < REPETITION_TABLE_BUCKET_SIZE)
-    {
-        bucket->hashStack[bucket->stackLength] = hash;
-        bucket->stackLength++;
-    }
-    else
-    {
-        if (bucket->hashListStart == NULL)
-        {
-            bucket->hashListStart = (RepetitionNode *) malloc(sizeof(RepetitionNode));
-            if (bucket->hashListStart != NULL)
-            {
-                bucket->hashListStart->hash = hash;
-                bucket->hashListStart->next = NULL;
-                bucket->hashListStart->prev = NULL;
-                bucket->hashListEnd = bucket->hashListStart;
-            }
-        }
-        else
-        {
-            assert(bucket->hashListEnd != NULL);
-            assert(bucket->hashListEnd->next == NULL);
-
-            RepetitionNode * newNode = (RepetitionNode *) malloc(sizeof(RepetitionNode));
-            if (newNode != NULL)
-            {
-                newNode->hash = hash;
-                newNode->next = NULL;
-                newNode->prev = bucket->hashListEnd;
-                bucket->hashListEnd->next = newNode;
-                bucket->hashListEnd = newNode;
-            }
-        }
-    }
+    assert(ply >= 0 && ply < REPETITION_STACK_SEARCH_PLY);
+    rs->hashes[rs->length + ply] = hash;
 }
 
-static inline void RepetitionTablePop(RepetitionTable * rt, uint64_t hash)
+// Checks whether the position at the given search ply already occurred, either earlier in the search path
+// or in the game history. Only positions with the same side to move are compared. Positions before the last
+// irreversible move or the last null move are not compared; a position reached again only because one side
+// passed is not a repetition. The null move does not reset the halfmove counter, so it is bounded separately.
+static FORCE_INLINE bool RepetitionStackContains(const RepetitionStack * rs, int32_t ply, uint64_t hash, uint8_t halfmoveCounter, int32_t pliesFromNull)
 {
-    RepetitionBucket * bucket = &rt->buckets[hash & rt->numBucketsMinusOne];
-    if (bucket->hashListStart == NULL)
+    assert(ply >= 0 && ply < REPETITION_STACK_SEARCH_PLY);
+    size_t top = rs->length + ply;
+    size_t distance = (halfmoveCounter < top) ? halfmoveCounter : top;
+    if ((size_t)pliesFromNull < distance)
+        distance = (size_t)pliesFromNull;
+    for (size_t i = REPETITION_MIN_DISTANCE; i <= distance; i += 2)
     {
-        if (bucket->stackLength > 0)
-            bucket->stackLength--;
-    }
-    else
-    {
-        assert(bucket->hashListEnd != NULL);
-
-        if (bucket->hashListStart == bucket->hashListEnd)
-        {
-            free(bucket->hashListStart);
-            bucket->hashListStart = NULL;
-            bucket->hashListEnd = NULL;
-        }
-        else
-        {
-            RepetitionNode * nodeToFree = bucket->hashListEnd;
-            bucket->hashListEnd = nodeToFree->prev;
-            bucket->hashListEnd->next = NULL;
-
-            free(nodeToFree);
-        }
+        if (rs->hashes[top - i] == hash)
+            return true;
     }
+    return false;
 }
 
 #endif // REPETITION_H_
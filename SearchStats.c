@@ -0,0 +1,166 @@
+#include "SearchStats.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#if SEARCH_STATS
+
+static const char * s_nodeTypeNames[NUM_SEARCH_NODE_TYPES] =
+{
+    "pv",
+    "nonpv",
+    "qsearch"
+};
+
+static const char * s_eventNames[NUM_SEARCH_EVENTS] =
+{
+    "ttcutoffs",
+    "nullmovecutoffs",
+    "lmrprunes",
+    "extensions",
+    "repetitions",
+    "upcomingrepetitions",
+    "aspirationfailures"
+};
+
+static void SearchStatsAdd(SearchStatsCounters * total, const SearchStatsCounters * counters)
+{
+    total->nodes += counters->nodes;
+    total->movesSearched += counters->movesSearched;
+    total->alphaUpdates += counters->alphaUpdates;
+    total->betaCutoffs += counters->betaCutoffs;
+    total->firstMoveCutoffs += counters->firstMoveCutoffs;
+    total->cutoffMoveIndexSum += counters->cutoffMoveIndexSum;
+    for (int bucket = 0; bucket < SEARCH_STATS_CUTOFF_BUCKETS; ++bucket)
+        total->cutoffMoveIndexBuckets[bucket] += counters->cutoffMoveIndexBuckets[bucket];
+    total->hashMoves += counters->hashMoves;
+    total->hashMoveCutoffs += counters->hashMoveCutoffs;
+    total->killerMoves += counters->killerMoves;
+    total->killerCutoffs += counters->killerCutoffs;
+    total->captureCutoffs += counters->captureCutoffs;
+}
+
+static void SearchStatsPrintCounters(const char * prefix, const SearchStatsCounters * counters)
+{
+    double firstMoveCutoffs = counters->betaCutoffs ? (100.0 * counters->firstMoveCutoffs) / counters->betaCutoffs : 0.0;
+    double cutoffMoveIndex = counters->betaCutoffs ? (double)counters->cutoffMoveIndexSum / counters->betaCutoffs : 0.0;
+    double movesPerNode = counters->nodes ? (double)counters->movesSearched / counters->nodes : 0.0;
+    printf("info string %s nodes %" PRIu64 " moves %" PRIu64 " movespernode %.2f alphaupdates %" PRIu64 " cutoffs %" PRIu64 " firstmovecutoffs %.1f%% avgcutoffindex %.2f\n",
+           prefix,
+           counters->nodes,
+           counters->movesSearched,
+           movesPerNode,
+           counters->alphaUpdates,
+           counters->betaCutoffs,
+           firstMoveCutoffs,
+           cutoffMoveIndex);
+}
+
+static double Percentage(uint64_t count, uint64_t total)
+{
+    return total ? (100.0 * count) / total : 0.0;
+}
+
+static void SearchStatsPrintOrdering(const char * prefix, const SearchStatsCounters * counters)
+{
+    static const char * s_bucketNames[SEARCH_STATS_CUTOFF_BUCKETS] = { "0", "1", "2", "3", "4-7", "8-15", "16+" };
+
+    printf("info string %s cutoffs %" PRIu64 " firstmove %.1f%% index", prefix, counters->betaCutoffs, Percentage(counters->firstMoveCutoffs, counters->betaCutoffs));
+    for (int bucket = 0; bucket < SEARCH_STATS_CUTOFF_BUCKETS; ++bucket)
+        printf(" %s:%.1f%%", s_bucketNames[bucket], Percentage(counters->cutoffMoveIndexBuckets[bucket], counters->betaCutoffs));
+    printf(" hashmove %" PRIu64 " success %.1f%% killer %" PRIu64 " success %.1f%% captures %.1f%% quiets %.1f%%\n",
+           counters->hashMoves,
+           Percentage(counters->hashMoveCutoffs, counters->hashMoves),
+           counters->killerMoves,
+           Percentage(counters->killerCutoffs, counters->killerMoves),
+           Percentage(counters->captureCutoffs, counters->betaCutoffs),
+           Percentage(counters->betaCutoffs - counters->captureCutoffs, counters->betaCutoffs));
+}
+
+void SearchStatsAccumulate(SearchStats * total, const SearchStats * stats)
+{
+    for (int depth = 0; depth < SEARCH_STATS_MAX_DEPTH; ++depth)
+    {
+        for (int type = 0; type < NUM_SEARCH_NODE_TYPES; ++type)
+            SearchStatsAdd(&total->counters[depth][type], &stats->counters[depth][type]);
+    }
+    for (int event = 0; event < NUM_SEARCH_EVENTS; ++event)
+        total->events[event] += stats->events[event];
+}
+
+void SearchStatsPrint(const SearchStats * stats)
+{
+    SearchStatsCounters totals[NUM_SEARCH_NODE_TYPES];
+    memset(totals, 0, sizeof(totals));
+    for (int depth = 0; depth < SEARCH_STATS_MAX_DEPTH; ++depth)
+    {
+        for (int type = 0; type < NUM_SEARCH_NODE_TYPES; ++type)
+            SearchStatsAdd(&totals[type], &stats->counters[depth][type]);
+    }
+
+    uint64_t allNodes = 0;
+    for (int type = 0; type < NUM_SEARCH_NODE_TYPES; ++type)
+        allNodes += totals[type].nodes;
+
+    char prefix[64];
+    for (int type = 0; type < NUM_SEARCH_NODE_TYPES; ++type)
+    {
+        snprintf(prefix, sizeof(prefix), "stats %s", s_nodeTypeNames[type]);
+        SearchStatsPrintCounters(prefix, &totals[type]);
+    }
+
+    printf("info string stats qsearchshare %.1f%%", allNodes ? (100.0 * totals[SearchNodeQuiescence].nodes) / allNodes : 0.0);
+    for (int event = 0; event < NUM_SEARCH_EVENTS; ++event)
+        printf(" %s %" PRIu64, s_eventNames[event], stats->events[event]);
+    printf("\n");
+
+    for (int depth = SEARCH_STATS_MAX_DEPTH - 1; depth >= 0; --depth)
+    {
+        for (int type = 0; type < NUM_SEARCH_NODE_TYPES; ++type)
+        {
+            const SearchStatsCounters * counters = &stats->counters[depth][type];
+            if (counters->nodes == 0)
+                continue;
+            snprintf(prefix, sizeof(prefix), "stats depth %i%s %s", depth, (depth == SEARCH_STATS_MAX_DEPTH - 1) ? "+" : "", s_nodeTypeNames[type]);
+            SearchStatsPrintCounters(prefix, counters);
+        }
+    }
+
+    // Move ordering: how early the cutoffs come, and which kinds of moves cause them.
+    for (int type = 0; type < NUM_SEARCH_NODE_TYPES; ++type)
+    {
+        snprintf(prefix, sizeof(prefix), "ordering %s", s_nodeTypeNames[type]);
+        SearchStatsPrintOrdering(prefix, &totals[type]);
+    }
+
+    for (int depth = SEARCH_STATS_MAX_DEPTH - 1; depth >= 0; --depth)
+    {
+        for (int type = 0; type < NUM_SEARCH_NODE_TYPES; ++type)
+        {
+            const SearchStatsCounters * counters = &stats->counters[depth][type];
+            if (counters->betaCutoffs == 0)
+                continue;
+            snprintf(prefix, sizeof(prefix), "ordering depth %i%s %s", depth, (depth == SEARCH_STATS_MAX_DEPTH - 1) ? "+" : "", s_nodeTypeNames[type]);
+            SearchStatsPrintOrdering(prefix, counters);
+        }
+    }
+
+    fflush(stdout);
+}
+
+#else
+
+void SearchStatsAccumulate(SearchStats * total, const SearchStats * stats)
+{
+    (void)total;
+    (void)stats;
+}
+
+void SearchStatsPrint(const SearchStats * stats)
+{
+    (void)stats;
+    printf("info string Search statistics are disabled; rebuild with SEARCH_STATS set to 1\n");
+    fflush(stdout);
+}
+
+#endif
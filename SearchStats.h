@@ -0,0 +1,159 @@
+#ifndef SEARCH_STATS_H_
+#define SEARCH_STATS_H_
+
+#include "Intrinsics.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+// Enables search statistics. When disabled, the counters and all of the update functions below compile to nothing, so
+// the search pays nothing for them.
+#define SEARCH_STATS 0
+
+// Counters are kept per remaining depth; deeper nodes share the last row. Quiescence nodes all go in row 0.
+#define SEARCH_STATS_MAX_DEPTH 32
+
+// Buckets of the histogram of the index of the move which caused a beta cutoff: 0, 1, 2, 3, 4-7, 8-15 and 16+.
+#define SEARCH_STATS_CUTOFF_BUCKETS 7
+
+// Kind of move which was searched, for the move ordering statistics. A move may be more than one kind.
+#define SEARCH_MOVE_HASH    0x01 // The transposition table move, or the previous best move at the root.
+#define SEARCH_MOVE_KILLER  0x02
+#define SEARCH_MOVE_CAPTURE 0x04
+
+typedef enum
+{
+    SearchNodePV,
+    SearchNodeNonPV,
+    SearchNodeQuiescence,
+    NUM_SEARCH_NODE_TYPES
+} SearchNodeType;
+
+// Events which are only counted in total, not per depth.
+typedef enum
+{
+    SearchEventTTCutoff,
+    SearchEventNullMoveCutoff,
+    SearchEventLMRPrune,
+    SearchEventExtension,
+    SearchEventRepetition,
+    SearchEventUpcomingRepetition,
+    SearchEventAspirationFailure,
+    NUM_SEARCH_EVENTS
+} SearchEvent;
+
+typedef struct
+{
+    uint64_t nodes;
+    uint64_t movesSearched;
+    uint64_t alphaUpdates;
+    uint64_t betaCutoffs;
+    uint64_t firstMoveCutoffs;
+    uint64_t cutoffMoveIndexSum; // Sum of the index of the move which caused each beta cutoff; 0 is the first move.
+    uint64_t cutoffMoveIndexBuckets[SEARCH_STATS_CUTOFF_BUCKETS];
+    uint64_t hashMoves;          // Hash moves searched, and how many of them caused a beta cutoff.
+    uint64_t hashMoveCutoffs;
+    uint64_t killerMoves;        // Killer moves searched, and how many of them caused a beta cutoff.
+    uint64_t killerCutoffs;
+    uint64_t captureCutoffs;     // Beta cutoffs by captures; the rest are by quiet moves.
+} SearchStatsCounters;
+
+#if SEARCH_STATS
+typedef struct
+{
+    SearchStatsCounters counters[SEARCH_STATS_MAX_DEPTH][NUM_SEARCH_NODE_TYPES];
+    uint64_t events[NUM_SEARCH_EVENTS];
+} SearchStats;
+#else
+typedef struct
+{
+    char unused;
+} SearchStats;
+#endif
+
+static FORCE_INLINE void SearchStatsClear(SearchStats * stats)
+{
+#if SEARCH_STATS
+    memset(stats, 0, sizeof(SearchStats));
+#else
+    (void)stats;
+#endif
+}
+
+#if SEARCH_STATS
+static FORCE_INLINE SearchStatsCounters * SearchStatsGetCounters(SearchStats * stats, SearchNodeType type, int32_t depth)
+{
+    if (depth < 0)
+        depth = 0;
+    else if (depth >= SEARCH_STATS_MAX_DEPTH)
+        depth = SEARCH_STATS_MAX_DEPTH - 1;
+    return &stats->counters[depth][type];
+}
+#endif
+
+static FORCE_INLINE void SearchStatsNode(SearchStats * stats, SearchNodeType type, int32_t depth)
+{
+#if SEARCH_STATS
+    SearchStatsGetCounters(stats, type, depth)->nodes++;
+#else
+    (void)stats; (void)type; (void)depth;
+#endif
+}
+
+// moveKind is a combination of the SEARCH_MOVE_ flags.
+static FORCE_INLINE void SearchStatsMove(SearchStats * stats, SearchNodeType type, int32_t depth, uint8_t moveKind)
+{
+#if SEARCH_STATS
+    SearchStatsCounters * counters = SearchStatsGetCounters(stats, type, depth);
+    counters->movesSearched++;
+    counters->hashMoves += (moveKind & SEARCH_MOVE_HASH) != 0;
+    counters->killerMoves += (moveKind & SEARCH_MOVE_KILLER) != 0;
+#else
+    (void)stats; (void)type; (void)depth; (void)moveKind;
+#endif
+}
+
+static FORCE_INLINE void SearchStatsAlphaUpdate(SearchStats * stats, SearchNodeType type, int32_t depth)
+{
+#if SEARCH_STATS
+    SearchStatsGetCounters(stats, type, depth)->alphaUpdates++;
+#else
+    (void)stats; (void)type; (void)depth;
+#endif
+}
+
+static FORCE_INLINE void SearchStatsCutoff(SearchStats * stats, SearchNodeType type, int32_t depth, int32_t moveIndex, uint8_t moveKind)
+{
+#if SEARCH_STATS
+    SearchStatsCounters * counters = SearchStatsGetCounters(stats, type, depth);
+    counters->betaCutoffs++;
+    counters->firstMoveCutoffs += (moveIndex == 0);
+    counters->cutoffMoveIndexSum += (uint64_t)moveIndex;
+    int bucket = (moveIndex < 4) ? moveIndex : ((moveIndex < 8) ? 4 : ((moveIndex < 16) ? 5 : 6));
+    counters->cutoffMoveIndexBuckets[bucket]++;
+    counters->hashMoveCutoffs += (moveKind & SEARCH_MOVE_HASH) != 0;
+    counters->killerCutoffs += (moveKind & SEARCH_MOVE_KILLER) != 0;
+    counters->captureCutoffs += (moveKind & SEARCH_MOVE_CAPTURE) != 0;
+#else
+    (void)stats; (void)type; (void)depth; (void)moveIndex; (void)moveKind;
+#endif
+}
+
+static FORCE_INLINE void SearchStatsEvent(SearchStats * stats, SearchEvent event)
+{
+#if SEARCH_STATS
+    stats->events[event]++;
+#else
+    (void)stats; (void)event;
+#endif
+}
+
+// Adds stats to total, e.g. to sum the statistics over several searches.
+extern void SearchStatsAccumulate(SearchStats * total, const SearchStats * stats);
+
+// Prints the statistics as info strings: totals and derived ratios per node type, the events, and one line per depth
+// for every depth which was visited; then the same for the move ordering statistics.
+extern void SearchStatsPrint(const SearchStats * stats);
+
+#endif // SEARCH_STATS_H_
@@ -0,0 +1,48 @@
+#include "SearchTrace.h"
+
+#if SEARCH_TRACE
+
+#include "MemoryMappedFile.h"
+
+#include <stdio.h>
+#include <string.h>
+
+TRACE_THREAD_LOCAL TraceHeader * g_traceHeader = NULL;
+TRACE_THREAD_LOCAL TraceRecord * g_traceRecords = NULL;
+
+static TRACE_THREAD_LOCAL MemoryMappedFile s_traceFile;
+
+// Searches never start concurrently, so handing out the indices needs no synchronization.
+static int s_nextThreadIndex = 0;
+
+bool SearchTraceOpen(uint32_t capacity)
+{
+    if (g_traceHeader != NULL)
+        return true;
+
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+        return false;
+
+    char filename[64];
+    snprintf(filename, sizeof(filename), "search-trace-%i.bin", s_nextThreadIndex);
+
+    MemoryMappedFileInitialize(&s_traceFile);
+    if (!MemoryMappedFileCreate(&s_traceFile, filename, sizeof(TraceHeader) + (uint64_t)capacity * sizeof(TraceRecord)))
+    {
+        fprintf(stderr, "Could not create search trace %s\n", filename);
+        return false;
+    }
+    s_nextThreadIndex++;
+
+    g_traceHeader = (TraceHeader *)MemoryMappedFileGetAddress(&s_traceFile);
+    g_traceRecords = (TraceRecord *)(g_traceHeader + 1);
+
+    memset(g_traceHeader, 0, sizeof(TraceHeader));
+    g_traceHeader->magic = SEARCH_TRACE_MAGIC;
+    g_traceHeader->version = SEARCH_TRACE_VERSION;
+    g_traceHeader->recordSize = sizeof(TraceRecord);
+    g_traceHeader->capacity = capacity;
+    return true;
+}
+
+#endif
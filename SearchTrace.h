@@ -0,0 +1,112 @@
+#ifndef SEARCH_TRACE_H_
+#define SEARCH_TRACE_H_
+
+#include "Intrinsics.h"
+#include "Move.h"
+#include "StaticAssert.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Enables the search trace recorder. Every node of the search appends one fixed size record to a memory-mapped ring
+// file, search-trace-<thread>.bin, which can be inspected afterwards with tools/TraceTool.c. The ring keeps the most
+// recent records, so the file size (and the cost per node) stays bounded however long the search runs. When disabled,
+// the recorder and all of the functions below compile to nothing.
+#define SEARCH_TRACE 0
+
+// Default number of records in the ring; must be a power of two. 4M records is 128MB per thread.
+#define SEARCH_TRACE_DEFAULT_CAPACITY (1u << 22)
+
+#define SEARCH_TRACE_MAGIC 0x45435254u // "TRCE"
+#define SEARCH_TRACE_VERSION 1
+
+// Why a node returned the score it did.
+typedef enum
+{
+    TraceReasonSearched,        // Searched all of its moves without a cutoff.
+    TraceReasonBetaCutoff,      // A move failed high.
+    TraceReasonAborted,         // The search was stopped.
+    TraceReasonDraw,            // Fifty move rule or insufficient material.
+    TraceReasonRepetition,      // Repeated a position, or could force one and that fails high.
+    TraceReasonTTCutoff,        // Transposition table bound.
+    TraceReasonTablebase,       // Syzygy WDL probe.
+    TraceReasonFutility,        // Static eval too far below alpha.
+    TraceReasonReverseFutility, // Static eval too far above beta.
+    TraceReasonNullMove,        // Null move search failed high.
+    TraceReasonNoMoves,         // Checkmate or stalemate.
+    TraceReasonStandPat,        // Quiescence search static eval failed high.
+    NUM_TRACE_REASONS
+} TraceReason;
+
+// How the parent searched the move leading to a node.
+#define TRACE_FLAG_NULL_MOVE   0x01 // Null move search; the move is empty.
+#define TRACE_FLAG_REDUCED     0x02 // Late move reduction.
+#define TRACE_FLAG_ZERO_WINDOW 0x04 // Zero window (scout) search.
+#define TRACE_FLAG_RESEARCH    0x08 // Search again after the reduced or zero window search failed high.
+
+typedef struct
+{
+    uint64_t hash;
+    int32_t alpha;     // Window the node was entered with.
+    int32_t beta;
+    int32_t score;     // Score the node returned.
+    EncodedMove move;  // Move which led to the node; 0 at the root and after null moves.
+    uint8_t ply;
+    int8_t depth;      // Remaining depth the node was entered with; quiescence depths are zero or negative.
+    uint8_t nodeType;  // SearchNodeType.
+    uint8_t reason;    // TraceReason.
+    uint8_t flags;     // TRACE_FLAG_*.
+    uint8_t reserved[5];
+} TraceRecord;
+
+STATIC_ASSERT(sizeof(TraceRecord) == 32, "Trace records must stay 32 bytes");
+
+// Start of the trace file; the ring of capacity records follows immediately. Records are written in post-order, when
+// a node returns, so each node is preceded by its whole subtree; record n is stored at index n % capacity.
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t capacity;
+    uint64_t numRecords; // Total number of records written; only the last min(numRecords, capacity) remain.
+    uint64_t reserved[5];
+} TraceHeader;
+
+STATIC_ASSERT(sizeof(TraceHeader) == sizeof(TraceRecord) * 2, "Trace header must keep the records aligned");
+
+#if SEARCH_TRACE
+
+#if defined(_MSC_VER)
+#define TRACE_THREAD_LOCAL __declspec(thread)
+#else
+#define TRACE_THREAD_LOCAL __thread
+#endif
+
+extern TRACE_THREAD_LOCAL TraceHeader * g_traceHeader;
+extern TRACE_THREAD_LOCAL TraceRecord * g_traceRecords;
+
+// Creates the trace file of the calling thread, unless it already has one. Each thread which searches gets the next
+// free index, starting from 0, and replaces any earlier trace file with that index. The file stays mapped until the
+// process exits, so the trace of the last searches can be read as soon as the engine quits.
+extern bool SearchTraceOpen(uint32_t capacity);
+
+static FORCE_INLINE void SearchTraceWrite(const TraceRecord * record)
+{
+    if (g_traceHeader == NULL)
+        return;
+    g_traceRecords[g_traceHeader->numRecords & (g_traceHeader->capacity - 1)] = *record;
+    g_traceHeader->numRecords++;
+}
+
+#else
+
+static FORCE_INLINE bool SearchTraceOpen(uint32_t capacity)
+{
+    (void)capacity;
+    return true;
+}
+
+#endif
+
+#endif // SEARCH_TRACE_H_
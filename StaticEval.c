@@ -182,23 +182,23 @@ static inline int32_t GetPieceValues(float midGameProgressionScalar, float endGa
 
 int32_t Evaluate(const Board * board)
 {
-    unsigned long long pieceCount = intrinsic_popcnt64(board->allPieceTables);
+    unsigned long long pieceCount = intrinsic_popcnt64(BoardGetOccupancy(board));
     if (pieceCount > 23)
         pieceCount = 23;
     float midGameProgressionScalar = MidGameScalar[pieceCount];
     float endGameProgressionScalar = EndGameScalar[pieceCount];
-    int32_t score = GetPieceValues(midGameProgressionScalar, endGameProgressionScalar, White, Pawn, board->whitePieceTables[PIECE_TABLE_PAWNS]);
-    score += GetPieceValues(midGameProgressionScalar, endGameProgressionScalar, White, Knight, board->whitePieceTables[PIECE_TABLE_KNIGHTS]);
-    score += GetPieceValues(midGameProgressionScalar, endGameProgressionScalar, White, Bishop, intrinsic_andn64(board->whitePieceTables[PIECE_TABLE_ROOKS_QUEENS], board->whitePieceTables[PIECE_TABLE_BISHOPS_QUEENS]));
-    score += GetPieceValues(midGameProgressionScalar, endGameProgressionScalar, White, Rook, intrinsic_andn64(board->whitePieceTables[PIECE_TABLE_BISHOPS_QUEENS], board->whitePieceTables[PIECE_TABLE_ROOKS_QUEENS]));
-    score += GetPieceValues(midGameProgressionScalar, endGameProgressionScalar, White, Queen, board->whitePieceTables[PIECE_TABLE_BISHOPS_QUEENS] & board->whitePieceTables[PIECE_TABLE_ROOKS_QUEENS]);
+    int32_t score = GetPieceValues(midGameProgressionScalar, endGameProgressionScalar, White, Pawn, BoardGetPlayerPieceTable(board, White, PIECE_TABLE_PAWNS));
+    score += GetPieceValues(midGameProgressionScalar, endGameProgressionScalar, White, Knight, BoardGetPlayerPieceTable(board, White, PIECE_TABLE_KNIGHTS));
+    score += GetPieceValues(midGameProgressionScalar, endGameProgressionScalar, White, Bishop, intrinsic_andn64(BoardGetPlayerPieceTable(board, White, PIECE_TABLE_ROOKS_QUEENS), BoardGetPlayerPieceTable(board, White, PIECE_TABLE_BISHOPS_QUEENS)));
+    score += GetPieceValues(midGameProgressionScalar, endGameProgressionScalar, White, Rook, intrinsic_andn64(BoardGetPlayerPieceTable(board, White, PIECE_TABLE_BISHOPS_QUEENS), BoardGetPlayerPieceTable(board, White, PIECE_TABLE_ROOKS_QUEENS)));
+    score += GetPieceValues(midGameProgressionScalar, endGameProgressionScalar, White, Queen, BoardGetPlayerPieceTable(board, White, PIECE_TABLE_BISHOPS_QUEENS) & BoardGetPlayerPieceTable(board, White, PIECE_TABLE_ROOKS_QUEENS));
     score += GetPieceValue(midGameProgressionScalar, endGameProgressionScalar, White, King, board->whiteKingSquare);
 
-    score -= GetPieceValues(midGameProgressionScalar, endGameProgressionScalar, Black, Pawn, board->blackPieceTables[PIECE_TABLE_PAWNS]);
-    score -= GetPieceValues(midGameProgressionScalar, endGameProgressionScalar, Black, Knight, board->blackPieceTables[PIECE_TABLE_KNIGHTS]);
-    score -= GetPieceValues(midGameProgressionScalar, endGameProgressionScalar, Black, Bishop, intrinsic_andn64(board->blackPieceTables[PIECE_TABLE_ROOKS_QUEENS], board->blackPieceTables[PIECE_TABLE_BISHOPS_QUEENS]));
-    score -= GetPieceValues(midGameProgressionScalar, endGameProgressionScalar, Black, Rook, intrinsic_andn64(board->blackPieceTables[PIECE_TABLE_BISHOPS_QUEENS], board->blackPieceTables[PIECE_TABLE_ROOKS_QUEENS]));
-    score -= GetPieceValues(midGameProgressionScalar, endGameProgressionScalar, Black, Queen, board->blackPieceTables[PIECE_TABLE_BISHOPS_QUEENS] & board->blackPieceTables[PIECE_TABLE_ROOKS_QUEENS]);
+    score -= GetPieceValues(midGameProgressionScalar, endGameProgressionScalar, Black, Pawn, BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_PAWNS));
+    score -= GetPieceValues(midGameProgressionScalar, endGameProgressionScalar, Black, Knight, BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_KNIGHTS));
+    score -= GetPieceValues(midGameProgressionScalar, endGameProgressionScalar, Black, Bishop, intrinsic_andn64(BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_ROOKS_QUEENS), BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_BISHOPS_QUEENS)));
+    score -= GetPieceValues(midGameProgressionScalar, endGameProgressionScalar, Black, Rook, intrinsic_andn64(BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_BISHOPS_QUEENS), BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_ROOKS_QUEENS)));
+    score -= GetPieceValues(midGameProgressionScalar, endGameProgressionScalar, Black, Queen, BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_BISHOPS_QUEENS) & BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_ROOKS_QUEENS));
     score -= GetPieceValue(midGameProgressionScalar, endGameProgressionScalar, Black, King, board->blackKingSquare);
 
     return score;
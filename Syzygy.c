@@ -357,15 +357,17 @@ static bool TBTableInit(TBTable * table, const String * code)
         return false;
 
     table->ready = false;
-    table->key = board.materialHash;
-    table->pieceCount = (int)intrinsic_popcnt64(board.allPieceTables);
-    table->hasPawns = (board.whitePieceTables[PIECE_TABLE_PAWNS] | board.blackPieceTables[PIECE_TABLE_PAWNS]) > 0;
+    table->key = ZobristCalculateMaterialHash(&board);
+    table->pieceCount = (int)intrinsic_popcnt64(BoardGetOccupancy(&board));
+    table->hasPawns = (BoardGetPlayerPieceTable(&board, White, PIECE_TABLE_PAWNS) | BoardGetPlayerPieceTable(&board, Black, PIECE_TABLE_PAWNS)) > 0;
 
+    // A piece is unique if its player has exactly one of its type, as in the reference implementation (piece types
+    // from pawn to below king). Queens are counted apart from bishops and rooks, not through the combined tables.
     table->hasUniquePieces = false;
-    for (PieceType i = Pawn; i <= NUM_PIECE_TYPES; ++i)
+    for (PieceType i = Pawn; i < King; ++i)
     {
-        if (intrinsic_popcnt64(board.whitePieceTables[i]) == 1 ||
-            intrinsic_popcnt64(board.blackPieceTables[i]) == 1)
+        if (intrinsic_popcnt64(BoardGetPieceTable(&board, White, i)) == 1 ||
+            intrinsic_popcnt64(BoardGetPieceTable(&board, Black, i)) == 1)
         {
             table->hasUniquePieces = true;
             break;
@@ -374,16 +376,16 @@ static bool TBTableInit(TBTable * table, const String * code)
 
     // Set the leading color. In case both sides have pawns the leading color
     // is the side with less pawns because this leads to better compression.
-    if ((board.blackPieceTables[PIECE_TABLE_PAWNS] == 0) ||
-        (board.whitePieceTables[PIECE_TABLE_PAWNS] > 0 && board.blackPieceTables[PIECE_TABLE_PAWNS] >= board.whitePieceTables[PIECE_TABLE_PAWNS]))
+    if ((BoardGetPlayerPieceTable(&board, Black, PIECE_TABLE_PAWNS) == 0) ||
+        (BoardGetPlayerPieceTable(&board, White, PIECE_TABLE_PAWNS) > 0 && BoardGetPlayerPieceTable(&board, Black, PIECE_TABLE_PAWNS) >= BoardGetPlayerPieceTable(&board, White, PIECE_TABLE_PAWNS)))
     {
-        table->pawnCount[0] = (uint8_t) intrinsic_popcnt64(board.whitePieceTables[PIECE_TABLE_PAWNS]);
-        table->pawnCount[1] = (uint8_t) intrinsic_popcnt64(board.blackPieceTables[PIECE_TABLE_PAWNS]);
+        table->pawnCount[0] = (uint8_t) intrinsic_popcnt64(BoardGetPlayerPieceTable(&board, White, PIECE_TABLE_PAWNS));
+        table->pawnCount[1] = (uint8_t) intrinsic_popcnt64(BoardGetPlayerPieceTable(&board, Black, PIECE_TABLE_PAWNS));
     }
     else
     {
-        table->pawnCount[0] = (uint8_t) intrinsic_popcnt64(board.blackPieceTables[PIECE_TABLE_PAWNS]);
-        table->pawnCount[1] = (uint8_t) intrinsic_popcnt64(board.whitePieceTables[PIECE_TABLE_PAWNS]);
+        table->pawnCount[0] = (uint8_t) intrinsic_popcnt64(BoardGetPlayerPieceTable(&board, Black, PIECE_TABLE_PAWNS));
+        table->pawnCount[1] = (uint8_t) intrinsic_popcnt64(BoardGetPlayerPieceTable(&board, White, PIECE_TABLE_PAWNS));
     }
 
     // This is kind of a necessary evil. I suppose it would be possible to write a Zobrist hashing function
@@ -392,7 +394,7 @@ static bool TBTableInit(TBTable * table, const String * code)
     if (!BoardParseCode(&board, Black, code))
         return false;
 
-    table->key2 = board.materialHash;
+    table->key2 = ZobristCalculateMaterialHash(&board);
 
     MemoryMappedFileInitialize(&table->mapping);
 
@@ -899,7 +901,7 @@ static int DoProbeTable(const Board * board, TBTable * table, TBType type, WDLSc
     // KRvK, not KvKR. A position where stronger side is white will have its
     // material key == table->key, otherwise we have to switch the color and
     // flip the squares before to lookup.
-    bool blackStronger = (board->materialHash != table->key);
+    bool blackStronger = (ZobristCalculateMaterialHash(board) != table->key);
 
     bool flipColor = (symmetricBlackToMove || blackStronger);
     int verticalFlip = flipColor ? 56 : 0;
@@ -953,7 +955,7 @@ static int DoProbeTable(const Board * board, TBTable * table, TBType type, WDLSc
 
     // Now we are ready to get all the position pieces (but the lead pawns) and
     // directly map them to the correct color and square.
-    b = board->allPieceTables ^ leadPawns;
+    b = BoardGetOccupancy(board) ^ leadPawns;
     while (b != 0)
     {
         Square s = SquareDecodeLowest(b);
@@ -1507,7 +1509,7 @@ static bool Mapped(TBTable * table, const Board * board, TBType type)
         }
     }
 
-    if (table->key == board->materialHash)
+    if (table->key == ZobristCalculateMaterialHash(board))
     {
         if (!StringConcat(&fname, &w))
             goto err;
@@ -1590,10 +1592,10 @@ err_fname:
 
 static int ProbeTable(const Board * board, ProbeState * result, WDLScore wdl, TBType type)
 {
-    if (intrinsic_popcnt64(board->allPieceTables) == 2)
+    if (intrinsic_popcnt64(BoardGetOccupancy(board)) == 2)
         return 0; // King versus King
 
-    TBTable * entry = TBTablesGet(&s_tbTables, board->materialHash, type);
+    TBTable * entry = TBTablesGet(&s_tbTables, ZobristCalculateMaterialHash(board), type);
 
     if (entry == NULL || !Mapped(entry, board, type))
     {
@@ -1620,7 +1622,7 @@ static int ProbeTable(const Board * board, ProbeState * result, WDLScore wdl, TB
 static WDLScore search(const Board * board, ProbeState * result, bool checkZeroingMoves)
 {
     WDLScore value, bestValue = WDLLoss;
-    uint64_t numPiecesRemaining = intrinsic_popcnt64(board->allPieceTables);
+    uint64_t numPiecesRemaining = intrinsic_popcnt64(BoardGetOccupancy(board));
 
     // TODO: Pass in moves from evaluation function so we don't need to eat up extra stack space here for no reason.
     Move moves[256];
@@ -1638,7 +1640,7 @@ static WDLScore search(const Board * board, ProbeState * result, bool checkZeroi
         nextBoard = *board;
         MakeMove(&nextBoard, move);
 
-        bool isCapture = numPiecesRemaining > intrinsic_popcnt64(nextBoard.allPieceTables);
+        bool isCapture = numPiecesRemaining > intrinsic_popcnt64(BoardGetOccupancy(&nextBoard));
         if (!isCapture && (!checkZeroingMoves || move.piece == Pawn))
             continue;
 
@@ -2033,7 +2035,7 @@ int SyzygyProbeDTZ(const Board * board, ProbeState * result)
     Move moves[256];
     uint8_t numMoves = GetValidMoves(board, moves);
     Board nextBoard;
-    unsigned long long numPiecesRemaining = intrinsic_popcnt64(board->allPieceTables);
+    unsigned long long numPiecesRemaining = intrinsic_popcnt64(BoardGetOccupancy(board));
 
     for (uint8_t i = 0; i < numMoves; ++i)
     {
@@ -2041,7 +2043,7 @@ int SyzygyProbeDTZ(const Board * board, ProbeState * result)
         nextBoard = *board;
         MakeMove(&nextBoard, move);
 
-        bool zeroing = move.piece == Pawn || (numPiecesRemaining > intrinsic_popcnt64(nextBoard.allPieceTables)); // is pawn or is capture
+        bool zeroing = move.piece == Pawn || (numPiecesRemaining > intrinsic_popcnt64(BoardGetOccupancy(&nextBoard))); // is pawn or is capture
 
         // For zeroing moves we want the dtz of the move _before_ doing it,
         // otherwise we will get the dtz of the next move sequence. Search the
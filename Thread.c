@@ -4,6 +4,7 @@
 #define __USE_GNU
 #include <errno.h>
 #include <time.h>
+#include <unistd.h>
 #endif
 
 bool ThreadStart(ThreadHandle * th, ThreadFunc func, void * param)
@@ -107,3 +108,15 @@ void ThreadSleep(size_t timeoutMs)
     Sleep((DWORD) timeoutMs);
 #endif
 }
+
+unsigned int ThreadGetNumProcessors()
+{
+#ifdef __GNUC__
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0) ? (unsigned int) n : 1;
+#else
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (info.dwNumberOfProcessors > 0) ? (unsigned int) info.dwNumberOfProcessors : 1;
+#endif
+}
@@ -24,4 +24,7 @@ extern bool ThreadDetach(ThreadHandle th);
 
 extern void ThreadSleep(size_t timeoutMs);
 
+// Number of logical processors available to the process; at least 1.
+extern unsigned int ThreadGetNumProcessors();
+
 #endif // THREAD_H_
@@ -0,0 +1,24 @@
+#include "Timer.h"
+
+#ifdef __GNUC__
+#include <time.h>
+#else
+#include "WindowsInclude.h"
+#endif
+
+uint64_t TimerGetMicroseconds()
+{
+#ifdef __GNUC__
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) < 0)
+        return 0;
+    return (uint64_t) ts.tv_sec * 1000000 + (uint64_t) ts.tv_nsec / 1000;
+#else
+    static LARGE_INTEGER s_frequency = { 0 };
+    if (s_frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&s_frequency);
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (uint64_t) ((counter.QuadPart / s_frequency.QuadPart) * 1000000 + ((counter.QuadPart % s_frequency.QuadPart) * 1000000) / s_frequency.QuadPart);
+#endif
+}
@@ -0,0 +1,10 @@
+#ifndef TIMER_H_
+#define TIMER_H_
+
+#include <stdint.h>
+
+// Monotonic wall clock time in microseconds, from an arbitrary starting point. Unlike clock(), this does not add up the
+// time of all threads, so it can be used to time multithreaded work.
+extern uint64_t TimerGetMicroseconds();
+
+#endif // TIMER_H_
@@ -7,13 +7,23 @@
 
 #include <assert.h>
 #include <limits.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <string.h>
 
 #define TT_EVAL_OFFSET 0x200000
 #define TT_DEPTH_OFFSET 0x80
 
+// Enables transposition table instrumentation: probe, hit, cutoff and replacement counters, plus a shadow copy of a
+// second key for every entry, which is independent of the hash, to count hits on entries of a different position.
+// Costs an extra 8 bytes per entry and a store/compare per access, so this is for debugging only.
+#define TT_STATS 0
+
+// Number of buckets sampled for hashfull, as in the UCI spec: per mille of the first 1000 buckets.
+#define TT_HASHFULL_SAMPLE_BUCKETS 1000
+
 typedef enum
 {
     TranspositionNone,
@@ -55,13 +65,33 @@ typedef struct
 
 STATIC_ASSERT(sizeof(TranspositionBucket) <= 64, "TranspositionBucket struct is too large for a single cache line");
 
+#if TT_STATS
+typedef struct
+{
+    uint64_t probes;
+    uint64_t hits[4]; // Indexed by the TranspositionType of the entry found.
+    uint64_t collisions; // Hits whose shadow key did not match; i.e. a different position with the same hash.
+    uint64_t cutoffs; // Hits which the search could return without searching; see TranspositionTableStatsCutoff.
+    uint64_t stores;
+    uint64_t storesEmpty; // Into an empty slot.
+    uint64_t storesUpdated; // Same position, replaced by a deeper search.
+    uint64_t storesSkipped; // Same position, but the existing entry was searched at least as deep; not replaced.
+    uint64_t evictions; // A different position was overwritten...
+    uint64_t evictionsDeeper; // ...which had been searched deeper than the new one.
+} TranspositionTableStats;
+#endif
+
 typedef struct
 {
     TranspositionBucket * buckets;
     // Store value minus one to make lookup and insertion one instruction faster, at expense of making clearing one instruction slower.
     // Lookup and insertion is MUCH more common, so this is a fair tradeoff.
     size_t numBucketsMinusOne;
-    uint64_t utilization;
+#if TT_STATS
+    uint64_t * shadowKeys; // One per entry, parallel to the buckets.
+    uint64_t shadowKey; // Key of the position being probed or stored; see TranspositionTableSetShadowKey.
+    TranspositionTableStats stats;
+#endif
 } TranspositionTable;
 
 static inline void TranspositionTableClear(TranspositionTable * tt);
@@ -76,8 +106,16 @@ static inline bool TranspositionTableInitialize(TranspositionTable * tt, size_t
     tt->buckets = (TranspositionBucket *)malloc(numBuckets * sizeof(TranspositionBucket));
     if (tt->buckets == NULL)
         return false;
+#if TT_STATS
+    tt->shadowKeys = (uint64_t *)malloc(numBuckets * TRANSPOSITION_TABLE_BUCKET_SIZE * sizeof(uint64_t));
+    if (tt->shadowKeys == NULL)
+    {
+        free(tt->buckets);
+        return false;
+    }
+    tt->shadowKey = 0;
+#endif
     tt->numBucketsMinusOne = numBuckets - 1;
-    tt->utilization = 0;
     TranspositionTableClear(tt);
     return true;
 }
@@ -85,13 +123,19 @@ static inline bool TranspositionTableInitialize(TranspositionTable * tt, size_t
 static inline void TranspositionTableDestroy(TranspositionTable * tt)
 {
     free(tt->buckets);
+#if TT_STATS
+    free(tt->shadowKeys);
+#endif
 }
 
 static inline void TranspositionTableClear(TranspositionTable * tt)
 {
     // TODO: Parallelize w/ threads? Stockfish parallelizes this operation.
     memset(tt->buckets, 0, (tt->numBucketsMinusOne + 1) * sizeof(TranspositionBucket));
-    tt->utilization = 0;
+#if TT_STATS
+    memset(tt->shadowKeys, 0, (tt->numBucketsMinusOne + 1) * TRANSPOSITION_TABLE_BUCKET_SIZE * sizeof(uint64_t));
+    memset(&tt->stats, 0, sizeof(TranspositionTableStats));
+#endif
 }
 
 static inline bool TranspositionTableResize(TranspositionTable * tt, size_t numBuckets)
@@ -123,15 +167,49 @@ static FORCE_INLINE int32_t TranspositionTableReadDepth(const Transposition * t)
     return ((int32_t) t->depth) - TT_DEPTH_OFFSET;
 }
 
+// Sets the shadow key of the position which the next lookups and inserts are for. Does nothing unless TT_STATS is set.
+static FORCE_INLINE void TranspositionTableSetShadowKey(TranspositionTable * tt, uint64_t shadowKey)
+{
+#if TT_STATS
+    tt->shadowKey = shadowKey;
+#else
+    (void)tt; (void)shadowKey;
+#endif
+}
+
+// Records that the search returned the value of the last hit without searching. Does nothing unless TT_STATS is set.
+static FORCE_INLINE void TranspositionTableStatsCutoff(TranspositionTable * tt)
+{
+#if TT_STATS
+    tt->stats.cutoffs++;
+#else
+    (void)tt;
+#endif
+}
+
+#if TT_STATS
+static FORCE_INLINE uint64_t * TranspositionTableGetShadowKey(TranspositionTable * tt, const TranspositionBucket * bucket, const Transposition * transposition)
+{
+    return &tt->shadowKeys[(size_t)(bucket - tt->buckets) * TRANSPOSITION_TABLE_BUCKET_SIZE + (size_t)(transposition - bucket->transpositions)];
+}
+#endif
+
 static inline TranspositionType TranspositionTableLookup(TranspositionTable * tt, uint64_t hash, EncodedMove * move, int32_t * eval, int32_t * depth)
 {
     assert(hash != 0);
     TranspositionBucket * bucket = &tt->buckets[hash & tt->numBucketsMinusOne];
+#if TT_STATS
+    tt->stats.probes++;
+#endif
     for (int i = 0; i < bucket->length; ++i)
     {
         Transposition * transposition = &bucket->transpositions[i];
         if ((hash & 0xFFFFFFFFFFFF0000ull) == (transposition->hashAndMove & 0xFFFFFFFFFFFF0000ull))
         {
+#if TT_STATS
+            tt->stats.hits[transposition->type]++;
+            tt->stats.collisions += (*TranspositionTableGetShadowKey(tt, bucket, transposition) != tt->shadowKey);
+#endif
             // Shuffle to put most recent transposition first (LRU cache).
             /*if (i > 0)
             {
@@ -154,6 +232,9 @@ static inline void TranspositionTableInsert(TranspositionTable * tt, uint64_t ha
     assert(hash != 0);
     TranspositionBucket * bucket = &tt->buckets[hash & tt->numBucketsMinusOne];
     Transposition * transposition = NULL;
+#if TT_STATS
+    tt->stats.stores++;
+#endif
 
     for (int i = 0; i < bucket->length; ++i)
     {
@@ -167,7 +248,17 @@ static inline void TranspositionTableInsert(TranspositionTable * tt, uint64_t ha
                 TranspositionTableStoreEval(transposition, evaluation);
                 TranspositionTableStoreDepth(transposition, depth);
                 transposition->type = type;
+#if TT_STATS
+                tt->stats.storesUpdated++;
+                *TranspositionTableGetShadowKey(tt, bucket, transposition) = tt->shadowKey;
+#endif
             }
+#if TT_STATS
+            else
+            {
+                tt->stats.storesSkipped++;
+            }
+#endif
             return;
         }
     }
@@ -178,8 +269,11 @@ static inline void TranspositionTableInsert(TranspositionTable * tt, uint64_t ha
         TranspositionTableStoreEval(&bucket->transpositions[bucket->length], evaluation);
         TranspositionTableStoreDepth(&bucket->transpositions[bucket->length], depth);
         bucket->transpositions[bucket->length].type = type;
+#if TT_STATS
+        tt->stats.storesEmpty++;
+        *TranspositionTableGetShadowKey(tt, bucket, &bucket->transpositions[bucket->length]) = tt->shadowKey;
+#endif
         bucket->length++;
-        tt->utilization++;
     }
     else
     {
@@ -190,6 +284,12 @@ static inline void TranspositionTableInsert(TranspositionTable * tt, uint64_t ha
                 transposition = &bucket->transpositions[i];
         }
 
+#if TT_STATS
+        tt->stats.evictions++;
+        tt->stats.evictionsDeeper += (TranspositionTableReadDepth(transposition) > depth);
+        *TranspositionTableGetShadowKey(tt, bucket, transposition) = tt->shadowKey;
+#endif
+
         // Replace at the lowest depth.
         transposition->hashAndMove = (hash & 0xFFFFFFFFFFFF0000ull) | move;
         TranspositionTableStoreEval(transposition, evaluation);
@@ -206,7 +306,6 @@ static inline void TranspositionTableInsert(TranspositionTable * tt, uint64_t ha
         TranspositionTableStoreDepth(&bucket->transpositions[0], depth);
         bucket->transpositions[0].type = type;
         bucket->length++;
-        tt->utilization++;
     }
     else
     {
@@ -218,9 +317,42 @@ static inline void TranspositionTableInsert(TranspositionTable * tt, uint64_t ha
     }*/
 }
 
+// Per mille of the entries in use, sampled over the first TT_HASHFULL_SAMPLE_BUCKETS buckets (the table always has more
+// than that). Entries spread uniformly over the buckets, so this is a good estimate of the whole table.
 static inline uint64_t TranspositionTableGetUtilization(const TranspositionTable * tt)
 {
-    return (tt->utilization * 1000) / (((uint64_t) tt->numBucketsMinusOne + 1) * TRANSPOSITION_TABLE_BUCKET_SIZE);
+    uint64_t used = 0;
+    for (size_t i = 0; i < TT_HASHFULL_SAMPLE_BUCKETS; ++i)
+        used += tt->buckets[i].length;
+    return (used * 1000) / (TT_HASHFULL_SAMPLE_BUCKETS * TRANSPOSITION_TABLE_BUCKET_SIZE);
+}
+
+// Prints the instrumentation counters as info strings, if compiled in.
+static inline void TranspositionTablePrintStats(const TranspositionTable * tt)
+{
+#if TT_STATS
+    const TranspositionTableStats * stats = &tt->stats;
+    uint64_t hits = stats->hits[TranspositionAlpha] + stats->hits[TranspositionBeta] + stats->hits[TranspositionExact];
+    printf("info string tt probes %" PRIu64 " hits %" PRIu64 " (%.1f%%) upper %" PRIu64 " lower %" PRIu64 " exact %" PRIu64 " cutoffs %" PRIu64 " collisions %" PRIu64 " (%.4f%% of hits)\n",
+           stats->probes,
+           hits,
+           stats->probes ? (100.0 * hits) / stats->probes : 0.0,
+           stats->hits[TranspositionAlpha],
+           stats->hits[TranspositionBeta],
+           stats->hits[TranspositionExact],
+           stats->cutoffs,
+           stats->collisions,
+           hits ? (100.0 * stats->collisions) / hits : 0.0);
+    printf("info string tt stores %" PRIu64 " empty %" PRIu64 " updated %" PRIu64 " skipped %" PRIu64 " evictions %" PRIu64 " evictionsofdeeper %" PRIu64 "\n",
+           stats->stores,
+           stats->storesEmpty,
+           stats->storesUpdated,
+           stats->storesSkipped,
+           stats->evictions,
+           stats->evictionsDeeper);
+#endif
+    printf("info string tt hashfull %" PRIu64 "\n", TranspositionTableGetUtilization(tt));
+    fflush(stdout);
 }
 
 static inline size_t TranspositionTableConvertNumBuckets(size_t sizeMB)
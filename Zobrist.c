@@ -1,3 +1,4 @@
+#include "Cuckoo.h"
 #include "Intrinsics.h"
 #include "PieceType.h"
 #include "Random.h"
@@ -35,6 +36,8 @@ void ZobristGenerate()
 
     s_zobristPlayerToMove[White] = 0;
     s_zobristPlayerToMove[Black] = RandomU64();
+
+    CuckooGenerate();
 }
 
 static FORCE_INLINE uint64_t ZobristForPieceTable(uint64_t pieceTable, Player player, PieceType piece)
@@ -50,18 +53,18 @@ static FORCE_INLINE uint64_t ZobristForPieceTable(uint64_t pieceTable, Player pl
 
 uint64_t ZobristCalculate(const Board * board)
 {
-    uint64_t hash = ZobristForPieceTable(board->whitePieceTables[PIECE_TABLE_PAWNS], White, Pawn);
-    hash ^= ZobristForPieceTable(board->whitePieceTables[PIECE_TABLE_KNIGHTS], White, Knight);
-    hash ^= ZobristForPieceTable(intrinsic_andn64(board->whitePieceTables[PIECE_TABLE_ROOKS_QUEENS], board->whitePieceTables[PIECE_TABLE_BISHOPS_QUEENS]), White, Bishop);
-    hash ^= ZobristForPieceTable(intrinsic_andn64(board->whitePieceTables[PIECE_TABLE_BISHOPS_QUEENS], board->whitePieceTables[PIECE_TABLE_ROOKS_QUEENS]), White, Rook);
-    hash ^= ZobristForPieceTable(board->whitePieceTables[PIECE_TABLE_BISHOPS_QUEENS] & board->whitePieceTables[PIECE_TABLE_ROOKS_QUEENS], White, Queen);
+    uint64_t hash = ZobristForPieceTable(BoardGetPlayerPieceTable(board, White, PIECE_TABLE_PAWNS), White, Pawn);
+    hash ^= ZobristForPieceTable(BoardGetPlayerPieceTable(board, White, PIECE_TABLE_KNIGHTS), White, Knight);
+    hash ^= ZobristForPieceTable(intrinsic_andn64(BoardGetPlayerPieceTable(board, White, PIECE_TABLE_ROOKS_QUEENS), BoardGetPlayerPieceTable(board, White, PIECE_TABLE_BISHOPS_QUEENS)), White, Bishop);
+    hash ^= ZobristForPieceTable(intrinsic_andn64(BoardGetPlayerPieceTable(board, White, PIECE_TABLE_BISHOPS_QUEENS), BoardGetPlayerPieceTable(board, White, PIECE_TABLE_ROOKS_QUEENS)), White, Rook);
+    hash ^= ZobristForPieceTable(BoardGetPlayerPieceTable(board, White, PIECE_TABLE_BISHOPS_QUEENS) & BoardGetPlayerPieceTable(board, White, PIECE_TABLE_ROOKS_QUEENS), White, Queen);
     hash ^= s_zobristPieces[White][King - 1][board->whiteKingSquare];
 
-    hash ^= ZobristForPieceTable(board->blackPieceTables[PIECE_TABLE_PAWNS], Black, Pawn);
-    hash ^= ZobristForPieceTable(board->blackPieceTables[PIECE_TABLE_KNIGHTS], Black, Knight);
-    hash ^= ZobristForPieceTable(intrinsic_andn64(board->blackPieceTables[PIECE_TABLE_ROOKS_QUEENS], board->blackPieceTables[PIECE_TABLE_BISHOPS_QUEENS]), Black, Bishop);
-    hash ^= ZobristForPieceTable(intrinsic_andn64(board->blackPieceTables[PIECE_TABLE_BISHOPS_QUEENS], board->blackPieceTables[PIECE_TABLE_ROOKS_QUEENS]), Black, Rook);
-    hash ^= ZobristForPieceTable(board->blackPieceTables[PIECE_TABLE_BISHOPS_QUEENS] & board->blackPieceTables[PIECE_TABLE_ROOKS_QUEENS], Black, Queen);
+    hash ^= ZobristForPieceTable(BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_PAWNS), Black, Pawn);
+    hash ^= ZobristForPieceTable(BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_KNIGHTS), Black, Knight);
+    hash ^= ZobristForPieceTable(intrinsic_andn64(BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_ROOKS_QUEENS), BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_BISHOPS_QUEENS)), Black, Bishop);
+    hash ^= ZobristForPieceTable(intrinsic_andn64(BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_BISHOPS_QUEENS), BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_ROOKS_QUEENS)), Black, Rook);
+    hash ^= ZobristForPieceTable(BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_BISHOPS_QUEENS) & BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_ROOKS_QUEENS), Black, Queen);
     hash ^= s_zobristPieces[Black][King - 1][board->blackKingSquare];
 
     if (board->enPassantSquare != SquareInvalid)
@@ -80,17 +83,17 @@ uint64_t ZobristCalculate(const Board * board)
 uint64_t ZobristCalculateMaterialHash(const Board * board)
 {
     // Note: Kings are always assumed to be on the board, so we can just ignore them for the material hash, which ignores position and only considers quantity of piece type.
-    uint64_t hash = s_zobristPieces[White][Pawn - 1][intrinsic_popcnt64(board->whitePieceTables[PIECE_TABLE_PAWNS])];
-    hash ^= s_zobristPieces[White][Knight - 1][intrinsic_popcnt64(board->whitePieceTables[PIECE_TABLE_KNIGHTS])];
-    hash ^= s_zobristPieces[White][Bishop - 1][intrinsic_popcnt64(intrinsic_andn64(board->whitePieceTables[PIECE_TABLE_ROOKS_QUEENS], board->whitePieceTables[PIECE_TABLE_BISHOPS_QUEENS]))];
-    hash ^= s_zobristPieces[White][Rook - 1][intrinsic_popcnt64(intrinsic_andn64(board->whitePieceTables[PIECE_TABLE_BISHOPS_QUEENS], board->whitePieceTables[PIECE_TABLE_ROOKS_QUEENS]))];
-    hash ^= s_zobristPieces[White][Queen - 1][intrinsic_popcnt64(board->whitePieceTables[PIECE_TABLE_BISHOPS_QUEENS] & board->whitePieceTables[PIECE_TABLE_ROOKS_QUEENS])];
+    uint64_t hash = s_zobristPieces[White][Pawn - 1][intrinsic_popcnt64(BoardGetPlayerPieceTable(board, White, PIECE_TABLE_PAWNS))];
+    hash ^= s_zobristPieces[White][Knight - 1][intrinsic_popcnt64(BoardGetPlayerPieceTable(board, White, PIECE_TABLE_KNIGHTS))];
+    hash ^= s_zobristPieces[White][Bishop - 1][intrinsic_popcnt64(intrinsic_andn64(BoardGetPlayerPieceTable(board, White, PIECE_TABLE_ROOKS_QUEENS), BoardGetPlayerPieceTable(board, White, PIECE_TABLE_BISHOPS_QUEENS)))];
+    hash ^= s_zobristPieces[White][Rook - 1][intrinsic_popcnt64(intrinsic_andn64(BoardGetPlayerPieceTable(board, White, PIECE_TABLE_BISHOPS_QUEENS), BoardGetPlayerPieceTable(board, White, PIECE_TABLE_ROOKS_QUEENS)))];
+    hash ^= s_zobristPieces[White][Queen - 1][intrinsic_popcnt64(BoardGetPlayerPieceTable(board, White, PIECE_TABLE_BISHOPS_QUEENS) & BoardGetPlayerPieceTable(board, White, PIECE_TABLE_ROOKS_QUEENS))];
 
-    hash ^= s_zobristPieces[Black][Pawn - 1][intrinsic_popcnt64(board->blackPieceTables[PIECE_TABLE_PAWNS])];
-    hash ^= s_zobristPieces[Black][Knight - 1][intrinsic_popcnt64(board->blackPieceTables[PIECE_TABLE_KNIGHTS])];
-    hash ^= s_zobristPieces[Black][Bishop - 1][intrinsic_popcnt64(intrinsic_andn64(board->blackPieceTables[PIECE_TABLE_ROOKS_QUEENS], board->blackPieceTables[PIECE_TABLE_BISHOPS_QUEENS]))];
-    hash ^= s_zobristPieces[Black][Rook - 1][intrinsic_popcnt64(intrinsic_andn64(board->blackPieceTables[PIECE_TABLE_BISHOPS_QUEENS], board->blackPieceTables[PIECE_TABLE_ROOKS_QUEENS]))];
-    hash ^= s_zobristPieces[Black][Queen - 1][intrinsic_popcnt64(board->blackPieceTables[PIECE_TABLE_BISHOPS_QUEENS] & board->blackPieceTables[PIECE_TABLE_ROOKS_QUEENS])];
+    hash ^= s_zobristPieces[Black][Pawn - 1][intrinsic_popcnt64(BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_PAWNS))];
+    hash ^= s_zobristPieces[Black][Knight - 1][intrinsic_popcnt64(BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_KNIGHTS))];
+    hash ^= s_zobristPieces[Black][Bishop - 1][intrinsic_popcnt64(intrinsic_andn64(BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_ROOKS_QUEENS), BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_BISHOPS_QUEENS)))];
+    hash ^= s_zobristPieces[Black][Rook - 1][intrinsic_popcnt64(intrinsic_andn64(BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_BISHOPS_QUEENS), BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_ROOKS_QUEENS)))];
+    hash ^= s_zobristPieces[Black][Queen - 1][intrinsic_popcnt64(BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_BISHOPS_QUEENS) & BoardGetPlayerPieceTable(board, Black, PIECE_TABLE_ROOKS_QUEENS))];
     return hash;
 }
 
@@ -183,50 +186,44 @@ void ZobristMerge(Board * board, Move move)
         }
     }
 
-    // Quick check for capture; hopefully this will shortcut most of the time.
-    if (board->allPieceTables & SquareEncode(move.to))
+    // The mailbox tells us directly whether this is a capture.
+    PieceType capturedPiece = BoardGetPieceAtSquare(board, move.to);
+    if (capturedPiece != None)
     {
-        PieceType capturedPiece = BoardGetPieceAtSquare(board, move.to);
-        if (capturedPiece != None)
+        board->hash ^= s_zobristPieces[!board->playerToMove][capturedPiece - 1][move.to];
+
+        // If the captured piece was a corner rook, mask off castling rights.
+        if (capturedPiece == Rook)
         {
-            board->hash ^= s_zobristPieces[!board->playerToMove][capturedPiece - 1][move.to];
-            uint8_t numPieces = BoardGetNumPieces(board, !board->playerToMove, capturedPiece);
-            board->materialHash ^= s_zobristPieces[!board->playerToMove][capturedPiece - 1][numPieces] // Removes hash
-                                 ^ s_zobristPieces[!board->playerToMove][capturedPiece - 1][numPieces - 1]; // Adds hash
+            uint8_t oldCastlingKey;
+            uint8_t newCastlingKey;
 
-            // If the captured piece was a corner rook, mask off castling rights.
-            if (capturedPiece == Rook)
+            switch (move.to)
             {
-                uint8_t oldCastlingKey;
-                uint8_t newCastlingKey;
-
-                switch (move.to)
-                {
-                case SquareA1:
-                    oldCastlingKey = board->castleBits;
-                    newCastlingKey = oldCastlingKey & ~(WhiteLongCastle);
-                    board->hash ^= s_zobristCastling[oldCastlingKey];
-                    board->hash ^= s_zobristCastling[newCastlingKey];
-                    break;
-                case SquareH1:
-                    oldCastlingKey = board->castleBits;
-                    newCastlingKey = oldCastlingKey & ~(WhiteShortCastle);
-                    board->hash ^= s_zobristCastling[oldCastlingKey];
-                    board->hash ^= s_zobristCastling[newCastlingKey];
-                    break;
-                case SquareA8:
-                    oldCastlingKey = board->castleBits;
-                    newCastlingKey = oldCastlingKey & ~(BlackLongCastle);
-                    board->hash ^= s_zobristCastling[oldCastlingKey];
-                    board->hash ^= s_zobristCastling[newCastlingKey];
-                    break;
-                case SquareH8:
-                    oldCastlingKey = board->castleBits;
-                    newCastlingKey = oldCastlingKey & ~(BlackShortCastle);
-                    board->hash ^= s_zobristCastling[oldCastlingKey];
-                    board->hash ^= s_zobristCastling[newCastlingKey];
-                    break;
-                }
+            case SquareA1:
+                oldCastlingKey = board->castleBits;
+                newCastlingKey = oldCastlingKey & ~(WhiteLongCastle);
+                board->hash ^= s_zobristCastling[oldCastlingKey];
+                board->hash ^= s_zobristCastling[newCastlingKey];
+                break;
+            case SquareH1:
+                oldCastlingKey = board->castleBits;
+                newCastlingKey = oldCastlingKey & ~(WhiteShortCastle);
+                board->hash ^= s_zobristCastling[oldCastlingKey];
+                board->hash ^= s_zobristCastling[newCastlingKey];
+                break;
+            case SquareA8:
+                oldCastlingKey = board->castleBits;
+                newCastlingKey = oldCastlingKey & ~(BlackLongCastle);
+                board->hash ^= s_zobristCastling[oldCastlingKey];
+                board->hash ^= s_zobristCastling[newCastlingKey];
+                break;
+            case SquareH8:
+                oldCastlingKey = board->castleBits;
+                newCastlingKey = oldCastlingKey & ~(BlackShortCastle);
+                board->hash ^= s_zobristCastling[oldCastlingKey];
+                board->hash ^= s_zobristCastling[newCastlingKey];
+                break;
             }
         }
     }
@@ -268,12 +265,6 @@ void ZobristMerge(Board * board, Move move)
             // Remove the pawn and replace it with the promotion.
             board->hash ^= s_zobristPieces[board->playerToMove][move.piece - 1][move.from];
             board->hash ^= s_zobristPieces[board->playerToMove][move.promotion - 1][move.to];
-            uint8_t numPawns = BoardGetNumPieces(board, board->playerToMove, Pawn);
-            uint8_t numPieces = BoardGetNumPieces(board, board->playerToMove, move.promotion);
-            board->materialHash ^= s_zobristPieces[board->playerToMove][Pawn - 1][numPawns] // Removes hash
-                                 ^ s_zobristPieces[board->playerToMove][Pawn - 1][numPawns - 1] // Adds hash
-                                 ^ s_zobristPieces[board->playerToMove][move.promotion - 1][numPieces] // Removes hash
-                                 ^ s_zobristPieces[board->playerToMove][move.promotion - 1][numPieces + 1]; // Adds hash
             return;
         }
     }
@@ -293,3 +284,14 @@ void ZobristSwapPlayer(Board * board)
     if (board->enPassantSquare != SquareInvalid)
         board->hash ^= s_zobristEnPassant[SquareGetFile(board->enPassantSquare)];
 }
+
+uint64_t ZobristGetPieceKey(Player player, PieceType piece, Square square)
+{
+    assert(piece != None && piece <= King);
+    return s_zobristPieces[player][piece - 1][square];
+}
+
+uint64_t ZobristGetPlayerToMoveKey()
+{
+    return s_zobristPlayerToMove[Black];
+}
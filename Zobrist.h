@@ -3,7 +3,9 @@
 
 #include "Board.h"
 #include "Move.h"
+#include "PieceType.h"
 #include "Player.h"
+#include "Square.h"
 
 #include <stdint.h>
 
@@ -14,5 +16,8 @@ extern uint64_t ZobristCalculate(const Board * board);
 extern uint64_t ZobristCalculateMaterialHash(const Board * board);
 extern void ZobristMerge(Board * board, Move move);
 extern void ZobristSwapPlayer(Board * board);
+extern uint64_t ZobristGetPieceKey(Player player, PieceType piece, Square square);
+// Key which is toggled in the hash whenever the player to move changes.
+extern uint64_t ZobristGetPlayerToMoveKey();
 
 #endif // ZOBRIST_H_
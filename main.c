@@ -1,3 +1,4 @@
+#include "Bench.h"
 #include "Board.h"
 #include "BoardStack.h"
 #include "Evaluation.h"
@@ -8,17 +9,21 @@
 #include "Logger.h"
 #include "Move.h"
 #include "MoveGeneration.h"
+#include "MoveTiming.h"
 #include "Mutex.h"
 #include "Options.h"
+#include "Perft.h"
 #include "Piece.h"
 #include "PieceType.h"
 #include "Player.h"
 #include "Rank.h"
+#include "Repetition.h"
 #include "Square.h"
 #include "StringStruct.h"
 #include "Syzygy.h"
 #include "Thread.h"
 #include "ThreadPool.h"
+#include "Timer.h"
 #include "Transposition.h"
 #include "Word.h"
 #include "Zobrist.h"
@@ -37,7 +42,13 @@
 #define DEFAULT_TT_SIZE_BUCKETS 0x200000
 #define DEFAULT_TT_SIZE_MB TranspositionTableConvertSize(DEFAULT_TT_SIZE_BUCKETS)
 
-bool ParseBoardSetup(Board * board, WordIterator * iter)
+// Positions played in the current game before the board position, used to detect repetitions across the game history.
+static RepetitionStack s_gameHistory;
+
+// Current transposition table size, restored after a bench.
+static uint32_t s_hashSizeMB = 0;
+
+bool ParseBoardSetup(Board * board, RepetitionStack * history, WordIterator * iter)
 {
     if (!WordIteratorValid(iter))
         return false;
@@ -79,10 +90,12 @@ bool ParseBoardSetup(Board * board, WordIterator * iter)
         fullFenStr[fullFenStrLen] = '\0';
         if (!ParseFEN(fullFenStr, board))
             return false;
+        RepetitionStackClear(history);
     }
     else if (StringIEquals(str, "startpos"))
     {
         BoardInitializeStartingPosition(board);
+        RepetitionStackClear(history);
         WordIteratorNext(iter);
     }
 
@@ -104,48 +117,13 @@ bool ParseBoardSetup(Board * board, WordIterator * iter)
         Move move;
         if (!ParseMove(StringGetChars(str), &move))
             return false;
-        EncodedSquare encoded = SquareEncode(move.from);
         // Determine which piece is being moved.
-        if (board->playerToMove == White)
-        {
-            if (board->whitePieceTables[PIECE_TABLE_PAWNS] & encoded)
-                move.piece = Pawn;
-            else if (board->whitePieceTables[PIECE_TABLE_KNIGHTS] & encoded)
-                move.piece = Knight;
-            else if (board->whitePieceTables[PIECE_TABLE_BISHOPS_QUEENS] & encoded)
-            {
-                if (board->whitePieceTables[PIECE_TABLE_ROOKS_QUEENS] & encoded)
-                    move.piece = Queen;
-                else
-                    move.piece = Bishop;
-            }
-            else if (board->whitePieceTables[PIECE_TABLE_ROOKS_QUEENS] & encoded)
-                move.piece = Rook;
-            else if (move.from == board->whiteKingSquare)
-                move.piece = King;
-            else
-                return false;
-        }
-        else
-        {
-            if (board->blackPieceTables[PIECE_TABLE_PAWNS] & encoded)
-                move.piece = Pawn;
-            else if (board->blackPieceTables[PIECE_TABLE_KNIGHTS] & encoded)
-                move.piece = Knight;
-            else if (board->blackPieceTables[PIECE_TABLE_BISHOPS_QUEENS] & encoded)
-            {
-                if (board->blackPieceTables[PIECE_TABLE_ROOKS_QUEENS] & encoded)
-                    move.piece = Queen;
-                else
-                    move.piece = Bishop;
-            }
-            else if (board->blackPieceTables[PIECE_TABLE_ROOKS_QUEENS] & encoded)
-                move.piece = Rook;
-            else if (move.from == board->blackKingSquare)
-                move.piece = King;
-            else
-                return false;
-        }
+        Player player;
+        BoardGetPlayerPieceAtSquare(board, move.from, &move.piece, &player);
+        if (move.piece == None || player != board->playerToMove)
+            return false;
+        if (!RepetitionStackPush(history, board->hash))
+            return false;
         MakeMove(board, move);
         WordIteratorNext(iter);
     }
@@ -154,6 +132,26 @@ bool ParseBoardSetup(Board * board, WordIterator * iter)
     return true;
 }
 
+static ConditionVariable s_sleeper;
+static Mutex s_sleeperMutex;
+static bool s_searchRunning = false; // From "go" until the search task returns; guarded by s_sleeperMutex.
+
+// Stops the search, if any, and waits until its task no longer uses the search state. ThreadPoolSync alone only waits
+// for queued tasks, so the search state must not be freed or cleared before this returns.
+static void EvalStopAndWait()
+{
+    MutexLock(&s_sleeperMutex);
+    while (s_searchRunning)
+    {
+        // A search task which has not started yet would clear the stop request, so keep repeating it.
+        EvalStop();
+        ConditionVariableWaitTimeout(&s_sleeper, &s_sleeperMutex, 10);
+    }
+    MutexUnlock(&s_sleeperMutex);
+    EvalStop();
+    ThreadPoolSync();
+}
+
 static void SetOption(const String * name, const String * value)
 {
     if (StringIEquals(name, "Hash"))
@@ -162,8 +160,10 @@ static void SetOption(const String * name, const String * value)
         uint32_t sizeMB = 0;
         if (ParseIntegerFromString(&c, &sizeMB))
         {
+            EvalStopAndWait();
             EvalDestroy();
             EvalInit(TranspositionTableConvertNumBuckets(sizeMB));
+            s_hashSizeMB = sizeMB;
             LoggerLogLinef("Set new transposition table size: %" PRIu32 " MB", sizeMB);
         }
     }
@@ -172,6 +172,13 @@ static void SetOption(const String * name, const String * value)
         EvalClear();
         LoggerLogLine("Cleared transposition table");
     }
+    else if (StringIEquals(name, "Perft Hash"))
+    {
+        const char * c = StringGetChars(value);
+        uint32_t sizeMB = 0;
+        if (ParseIntegerFromString(&c, &sizeMB) && PerftSetHashSize(sizeMB))
+            LoggerLogLinef("Set new perft hash table size: %" PRIu32 " MB", sizeMB);
+    }
     else if (StringIEquals(name, "Debug Log File"))
     {
         const char * c = StringGetChars(value);
@@ -187,6 +194,24 @@ static void SetOption(const String * name, const String * value)
             LoggerLogLinef("Set move overhead: %" PRIu32 " ms", overheadMs);
         }
     }
+    else if (StringIEquals(name, "Slider Attacks"))
+    {
+        SliderBackend backend;
+        if (StringIEquals(value, "PEXT"))
+            backend = SliderBackendPext;
+        else if (StringIEquals(value, "Magic"))
+            backend = SliderBackendMagic;
+        else
+            backend = GetPreferredSliderBackend();
+
+        // The switch rewrites the attack tables' indices one square at a time, so nothing may generate moves during
+        // it. Perft joins its threads before the command returns; only a search can still be running.
+        EvalStopAndWait();
+        if (SetSliderBackend(backend))
+            LoggerLogLinef("Set slider attacks: %s", (backend == SliderBackendPext) ? "PEXT" : "Magic");
+        else
+            printf("info string Slider attacks %s not supported on this CPU\n", StringGetChars(value));
+    }
 }
 
 typedef struct
@@ -194,22 +219,24 @@ typedef struct
     Board * board;
     MoveLine line;
     uint32_t optimalMoveTime;
+    uint32_t maxTime; // Time at which the search is stopped; 0xFFFFFFFF if none.
     uint32_t maxDepth;
     bool commit;
+    uint64_t receivedMicroseconds; // When the "go" command was received.
 
 } EvalContext;
 
-static ConditionVariable s_sleeper;
-static Mutex s_sleeperMutex;
-
 static void EvalThread(void * param)
 {
     EvalContext * context = (EvalContext *) param;
 
-    if (EvalStart(context->board, context->optimalMoveTime, context->maxDepth, &context->line))
+    if (EvalStart(context->board, &s_gameHistory, context->optimalMoveTime, context->maxDepth, &context->line))
     {
         if (context->commit)
+        {
+            RepetitionStackPush(&s_gameHistory, context->board->hash);
             MakeMove(context->board, context->line.moves[0]);
+        }
 
         char moveStr[6]; // Max 5 chars plus extra character for null-termination
         memset(moveStr, 0, sizeof(moveStr));
@@ -230,6 +257,11 @@ static void EvalThread(void * param)
 
             // Required for use with GUIs, to make sure buffered printf/puts is actually written to stdout.
             fflush(stdout);
+
+            uint64_t latency = TimerGetMicroseconds() - context->receivedMicroseconds;
+            MoveTimingRecord(latency, context->optimalMoveTime, context->maxTime);
+            LoggerLogLinef("Move time: %.1f ms, soft limit %" PRIu32 " ms, hard limit %" PRIu32 " ms",
+                           latency / 1000.0, context->optimalMoveTime, context->maxTime);
         }
         else
         {
@@ -242,6 +274,9 @@ static void EvalThread(void * param)
         // TODO: Not really sure what the error handling should be in this case...
     }
 
+    MutexLock(&s_sleeperMutex);
+    s_searchRunning = false;
+    MutexUnlock(&s_sleeperMutex);
     ConditionVariableSignalAll(&s_sleeper);
 }
 
@@ -254,7 +289,7 @@ static void EvalTimedStop(void * param)
     EvalStop();
 }
 
-static void CommandGo(Board * board, WordIterator * iter)
+static void CommandGo(Board * board, WordIterator * iter, uint64_t receivedMicroseconds)
 {
     EvalContext * context = (EvalContext *) malloc(sizeof(EvalContext));
     if (context != NULL)
@@ -263,6 +298,7 @@ static void CommandGo(Board * board, WordIterator * iter)
         context->maxDepth = MAX_LINE_DEPTH;
         context->optimalMoveTime = 0xFFFFFFFF;
         context->commit = false;
+        context->receivedMicroseconds = receivedMicroseconds;
 
         uint32_t totalTime = 0xFFFFFFFF;
         uint32_t moveTime = 0xFFFFFFFF;
@@ -391,32 +427,16 @@ static void CommandGo(Board * board, WordIterator * iter)
         }
 
         // Calculate time to spend on this move.
-        uint32_t maxTimeOnMove = 0xFFFFFFFF;
-        uint32_t optimalTimeOnMove = 0xFFFFFFFF;
-
-        if (moveTime != 0xFFFFFFFF)
-        {
-            maxTimeOnMove = moveTime - g_optionMoveOverhead;
-            optimalTimeOnMove = moveTime;
-        }
-        else if (totalTime != 0xFFFFFFFF)
-        {
-            // Have enough time remaining for at most 40 moves. As time decreases, this will slowly cause moves to speed up.
-            if (movesToGo == 0 || movesToGo > 40)
-                movesToGo = 40;
-            maxTimeOnMove = totalTime / movesToGo;
-            // Include increment if present.
-            if (timeIncrement != 0xFFFFFFFF)
-                maxTimeOnMove += timeIncrement;
-            // Subtract off any latency time between the engine and the GUI.
-            maxTimeOnMove -= g_optionMoveOverhead;
-            // Set optimal time usage to be 75% of the maximum time.
-            // This math does the division first intentionally, both to avoid overflow and to be conservative (value will be rounded down slightly).
-            optimalTimeOnMove = (maxTimeOnMove / 4) * 3;
-        }
+        uint32_t maxTimeOnMove;
+        uint32_t optimalTimeOnMove;
+        MoveTimingGetLimits(moveTime, totalTime, timeIncrement, movesToGo, g_optionMoveOverhead, &optimalTimeOnMove, &maxTimeOnMove);
 
         context->optimalMoveTime = optimalTimeOnMove;
+        context->maxTime = maxTimeOnMove;
 
+        MutexLock(&s_sleeperMutex);
+        s_searchRunning = true;
+        MutexUnlock(&s_sleeperMutex);
         if (ThreadPoolQueue(&EvalThread, context, &free))
         {
             if (maxTimeOnMove != 0xFFFFFFFF)
@@ -429,22 +449,86 @@ static void CommandGo(Board * board, WordIterator * iter)
         }
         else
         {
+            MutexLock(&s_sleeperMutex);
+            s_searchRunning = false;
+            MutexUnlock(&s_sleeperMutex);
             free(context);
         }
     }
 }
 
+// Custom command; "perft <depth> [threads]" counts the leaf nodes of the move tree, "divide" also prints the count below
+// each root move. Runs on all logical processors unless a thread count is given.
+static void CommandPerft(const Board * board, WordIterator * iter, bool divide)
+{
+    uint32_t depth = 1;
+    uint32_t numThreads = ThreadGetNumProcessors();
+
+    if (WordIteratorValid(iter))
+    {
+        const char * zz = StringGetChars(WordIteratorGet(iter));
+        ParseIntegerFromString(&zz, &depth);
+        WordIteratorNext(iter);
+    }
+    if (WordIteratorValid(iter))
+    {
+        const char * zz = StringGetChars(WordIteratorGet(iter));
+        ParseIntegerFromString(&zz, &numThreads);
+        WordIteratorNext(iter);
+    }
+
+    uint64_t begin = TimerGetMicroseconds();
+    uint64_t nodes = 0;
+    if (!Perft(board, depth, numThreads, divide, &nodes))
+    {
+        puts("info string perft failed");
+        return;
+    }
+    uint64_t elapsed = TimerGetMicroseconds() - begin;
+    if (elapsed == 0)
+        elapsed = 1;
+
+    printf("\nNodes searched: %" PRIu64 "\n", nodes);
+    printf("Time: %" PRIu64 " ms, %.1f Mnps\n", elapsed / 1000, (double) nodes / (double) elapsed);
+}
+
+// Custom command; "bench [depth] [threads] [hash]" searches the built-in bench positions, and
+// "bench scaling [depth] [max threads] [hash]" repeats that for an increasing number of threads. Also available as a
+// command line argument, in which case the engine exits after the bench.
+static bool CommandBench(const char * const * args, int numArgs)
+{
+    bool scaling = (numArgs > 0 && strcmp(args[0], "scaling") == 0);
+    if (scaling)
+    {
+        args++;
+        numArgs--;
+    }
+
+    uint32_t params[3] = { BENCH_DEFAULT_DEPTH, BENCH_DEFAULT_THREADS, BENCH_DEFAULT_HASH_MB };
+    for (int i = 0; i < numArgs && i < 3; ++i)
+    {
+        const char * zz = args[i];
+        ParseIntegerFromString(&zz, &params[i]);
+    }
+
+    if (scaling)
+        return BenchScaling(params[0], params[1], params[2], s_hashSizeMB);
+    else
+        return Bench(params[0], params[1], params[2], s_hashSizeMB);
+}
+
 int main(int argc, char ** argv)
 {
     if (!LoggerInit("log.txt"))
         return 1;
 
-    int result = Init(NULL);
+    int result = Init();
     if (result != 0)
         return result;
 
-    if (!EvalInit(0x200000))
+    if (!EvalInit(DEFAULT_TT_SIZE_BUCKETS))
         return 1;
+    s_hashSizeMB = (uint32_t) DEFAULT_TT_SIZE_MB;
 
     ZobristGenerate();
 
@@ -459,6 +543,12 @@ int main(int argc, char ** argv)
     if (!MutexInitialize(&s_sleeperMutex))
         return 1;
 
+    if (!RepetitionStackInitialize(&s_gameHistory, 1024))
+        return 1;
+
+    if (!MoveTimingInitialize())
+        return 1;
+
 #ifdef _WIN32
     bool syzygyInitialized = SyzygyInit(".;syzygy\\3-4-5-dtz-nr;syzygy\\3-4-5-wdl;..\\..\\syzygy\\3-4-5-dtz-nr;..\\..\\syzygy\\3-4-5-wdl");
 #else
@@ -468,6 +558,20 @@ int main(int argc, char ** argv)
     if (!syzygyInitialized)
         puts("Warning: Syzygy end game tablebase not found.\n");
 
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        result = CommandBench((const char * const *) &argv[2], argc - 2) ? 0 : 1;
+        if (syzygyInitialized)
+            SyzygyDestroy();
+        EvalDestroy();
+        ThreadPoolDestroy();
+        RepetitionStackDestroy(&s_gameHistory);
+        MoveTimingDestroy();
+        Cleanup();
+        LoggerDestroy();
+        return result;
+    }
+
     char c = 0;
     Board board;
     BoardInitializeStartingPosition(&board);
@@ -500,6 +604,9 @@ int main(int argc, char ** argv)
     {
         if (c == '\n')
         {
+            // Time at which the command was received, to measure the latency of "go" until "bestmove".
+            uint64_t receivedMicroseconds = TimerGetMicroseconds();
+
             // Handle last word if needed.
             if (StringLength(&nextWord) > 0)
             {
@@ -522,7 +629,7 @@ int main(int argc, char ** argv)
                     WordIteratorNext(&iter);
 
                     if (StringIEquals(str, "position"))
-                        ParseBoardSetup(&board, &iter);
+                        ParseBoardSetup(&board, &s_gameHistory, &iter);
                     else if (StringIEquals(str, "isready"))
                         puts("readyok");
                     else if (StringIEquals(str, "uci"))
@@ -533,6 +640,8 @@ int main(int argc, char ** argv)
                         printf("option name Hash type spin default %" PRIu64 " min 4 max 1048576\n", (uint64_t)DEFAULT_TT_SIZE_MB);
                         puts("option name Clear Hash type button");
                         puts("option name Move Overhead type spin default 100 min 0 max 5000");
+                        printf("option name Perft Hash type spin default %d min 0 max 1048576\n", PERFT_HASH_DEFAULT_SIZE_MB);
+                        puts("option name Slider Attacks type combo default Auto var Auto var PEXT var Magic");
                         puts("uciok");
                     }
                     else if (StringIEquals(str, "debug"))
@@ -548,7 +657,7 @@ int main(int argc, char ** argv)
                     }
                     else if (StringIEquals(str, "go"))
                     {
-                        CommandGo(&board, &iter);
+                        CommandGo(&board, &iter, receivedMicroseconds);
                     }
                     // Custom parameter; applies a move to the board position without needing to specify the complete fen.
                     else if (StringIEquals(str, "nextmove"))
@@ -563,11 +672,45 @@ int main(int argc, char ** argv)
                             if (ParseMove(zz, &move))
                             {
                                 Player playerMoving = White;
+                                uint64_t hash = board.hash;
                                 if (MakeMove2(&board, move, &playerMoving))
+                                {
+                                    RepetitionStackPush(&s_gameHistory, hash);
                                     puts("ok");
+                                }
                             }
                         }
                     }
+                    else if (StringIEquals(str, "bench"))
+                    {
+                        const char * args[4];
+                        int numArgs = 0;
+                        while (WordIteratorValid(&iter) && numArgs < 4)
+                        {
+                            args[numArgs++] = StringGetChars(WordIteratorGet(&iter));
+                            WordIteratorNext(&iter);
+                        }
+                        EvalStopAndWait();
+                        CommandBench(args, numArgs);
+                    }
+                    else if (StringIEquals(str, "timing"))
+                    {
+                        // Custom command; prints the time taken from "go" to "bestmove" over the session.
+                        MoveTimingPrint();
+                    }
+                    else if (StringIEquals(str, "stats"))
+                    {
+                        // Custom command; prints the statistics of the last search, if compiled in (SEARCH_STATS).
+                        EvalPrintStats();
+                    }
+                    else if (StringIEquals(str, "perft"))
+                    {
+                        CommandPerft(&board, &iter, false);
+                    }
+                    else if (StringIEquals(str, "divide"))
+                    {
+                        CommandPerft(&board, &iter, true);
+                    }
                     // Custom parameter; prints the board state in FEN.
                     else if (StringIEquals(str, "printfen"))
                     {
@@ -588,9 +731,8 @@ int main(int argc, char ** argv)
                     }
                     else if (StringIEquals(str, "ucinewgame"))
                     {
-                        EvalStop();
+                        EvalStopAndWait();
                         EvalClear();
-                        ThreadPoolSync();
                     }
                     else if (StringIEquals(str, "setoption"))
                     {
@@ -669,10 +811,16 @@ int main(int argc, char ** argv)
     WordListDestroy(&words);
     StringDestroy(&nextWord);
     StringDestroy(&line);
+    EvalStopAndWait();
+    // After the last search has recorded its move, which is often the one which ran out of time.
+    MoveTimingLog();
     if (syzygyInitialized)
         SyzygyDestroy();
     EvalDestroy();
+    PerftDestroy();
     ThreadPoolDestroy();
+    RepetitionStackDestroy(&s_gameHistory);
+    MoveTimingDestroy();
     Cleanup();
     LoggerDestroy();
     return 0;
@@ -5,12 +5,36 @@
 
 #include <stdint.h>
 
-extern const uint64_t * s_rookBlockerBitboards[NUM_SQUARES];
-extern uint64_t * s_rookBlockerBitboardsContiguous;
+// How slider attack tables are indexed. Both backends use the same blocker masks and tables of the same size;
+// only the mapping of an occupancy to a table slot (and so the layout of the table) differs.
+typedef enum
+{
+    SliderBackendPext,  // Index is pext(occupancy, mask). Requires BMI2; slow on CPUs with microcoded PEXT (AMD Zen 1/2).
+    SliderBackendMagic  // Index is ((occupancy & mask) * magic) >> (64 - bits). Runs anywhere.
+} SliderBackend;
+
+extern SliderBackend g_sliderBackend;
+
+// Everything needed to look up the attacks of a slider on one square, grouped so that a lookup reads a single
+// struct followed by one 16 bit pool offset and one attack set.
+typedef struct
+{
+    uint64_t blockerMask;
+    uint64_t magic;
+    const uint16_t * attackIndices; // Offsets into attackPool, indexed by the slider index of the current backend.
+    const uint64_t * attackPool; // Unique attack sets, shared by all squares.
+    uint64_t moveBitboard;
+    uint8_t indexBits;
+} SliderAttackTable;
+
+extern SliderAttackTable s_rookAttackTables[NUM_SQUARES];
 extern uint64_t s_rookBlockerMasks[NUM_SQUARES];
-extern const uint64_t * s_bishopBlockerBitboards[NUM_SQUARES];
-extern uint64_t * s_bishopBlockerBitboardsContiguous;
+extern const uint8_t s_rookBlockerIndexBits[NUM_SQUARES];
+extern const uint64_t s_rookMagics[NUM_SQUARES];
+extern SliderAttackTable s_bishopAttackTables[NUM_SQUARES];
 extern uint64_t s_bishopBlockerMasks[NUM_SQUARES];
+extern const uint8_t s_bishopBlockerIndexBits[NUM_SQUARES];
+extern const uint64_t s_bishopMagics[NUM_SQUARES];
 extern const uint64_t s_pawnAttackBitboardWhite[NUM_SQUARES];
 extern const uint64_t s_pawnAttackBitboardBlack[NUM_SQUARES];
 extern const uint64_t s_pawnShortMoveBitboardWhite[NUM_SQUARES];
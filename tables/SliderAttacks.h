@@ -0,0 +1,14 @@
+#ifndef SLIDER_ATTACKS_H_
+#define SLIDER_ATTACKS_H_
+
+#include <stdint.h>
+
+// Compressed slider attack tables; see SliderAttackTable in MoveTables.h.
+extern const uint64_t s_rookAttackPool[];
+extern const uint16_t s_rookPextAttackIndices[];
+extern const uint16_t s_rookMagicAttackIndices[];
+extern const uint64_t s_bishopAttackPool[];
+extern const uint16_t s_bishopPextAttackIndices[];
+extern const uint16_t s_bishopMagicAttackIndices[];
+
+#endif // SLIDER_ATTACKS_H_
@@ -1,251 +1,134 @@
+#include "Intrinsics.h"
 #include "Square.h"
+#include "tables/MoveTables.h"
 
+#include <inttypes.h>
 #include <stdio.h>
-#include <stdint.h>
+#include <stdlib.h>
 
 //#define BITBOARD_GENERATION
 
-int GenerateRookBlockerBitboards()
-{
-    FILE * of = fopen("rookBlockerBitboards.bin", "wb");
-    if (of == NULL)
-        return 1;
-
-    //fprintf(of, "static const uint64_t s_rookMoveBitboards[64][4096] = {\n");
+// Generates tables/SliderAttacks.c: the compressed slider attack tables which are linked into the engine as const data.
+// For each piece there is a pool of unique attack sets, plus one 16 bit pool offset per slider index, once in PEXT
+// order and once in magic order. Both index tables share the same pool and per-square layout.
 
-    for (Square square = 0; square < 64; ++square)
+// Walks each ray from the given square until (and including) the first blocker.
+static uint64_t SlidingAttacks(Square square, uint64_t occupied, const int directions[4][2])
+{
+    uint64_t attacks = 0;
+    for (int d = 0; d < 4; ++d)
     {
-        File f, f1, f2;
-        Rank r, r1, r2;
-
-        f = SquareGetFile(square);
-        r = SquareGetRank(square);
-
-        EncodedSquare combined = 0;
-        EncodedSquare checkSquare = 0;
-
-        f1 = f;
-        while (f1-- > FileB)
-            combined |= SquareEncodeRankFile(r, f1);
-
-        f2 = f + 1;
-        while (f2 <= FileG)
+        int r = (int) SquareGetRank(square) + directions[d][0];
+        int f = (int) SquareGetFile(square) + directions[d][1];
+        while (r >= Rank1 && r <= Rank8 && f >= FileA && f <= FileH)
         {
-            combined |= SquareEncodeRankFile(r, f2);
-            f2++;
+            EncodedSquare s = SquareEncodeRankFile((Rank) r, (File) f);
+            attacks |= s;
+            if (occupied & s)
+                break;
+            r += directions[d][0];
+            f += directions[d][1];
         }
-
-        r1 = r;
-        while (r1-- > Rank2)
-            combined |= SquareEncodeRankFile(r1, f);
-
-        r2 = r + 1;
-        while (r2 <= Rank7)
-        {
-            combined |= SquareEncodeRankFile(r2, f);
-            r2++;
-        }
-
-        printf("\t0x%016" PRIx64 "\n", combined);
-
-        //fprintf(of, "{ ");
-
-        uint64_t numBits = intrinsic_popcnt64(combined);
-        uint64_t numBoards = 1ull << numBits;
-        for (uint64_t i = 0; i < numBoards; ++i)
-        {
-            uint64_t bitboard = intrinsic_pext64(i, combined);
-            uint64_t mask = 0;
-
-            f1 = f;
-            while (f1-- > FileA)
-            {
-                checkSquare = SquareEncodeRankFile(r, f1);
-                mask |= checkSquare;
-                if (bitboard & checkSquare)
-                    break;
-            }
-
-            f2 = f + 1;
-            while (f2 <= FileH)
-            {
-                checkSquare = SquareEncodeRankFile(r, f2);
-                mask |= checkSquare;
-                if (bitboard & checkSquare)
-                    break;
-                f2++;
-            }
-
-            r1 = r;
-            while (r1-- > Rank1)
-            {
-                checkSquare = SquareEncodeRankFile(r1, f);
-                mask |= checkSquare;
-                if (bitboard & checkSquare)
-                    break;
-            }
-
-            r2 = r + 1;
-            while (r2 <= Rank8)
-            {
-                checkSquare = SquareEncodeRankFile(r2, f);
-                mask |= checkSquare;
-                if (bitboard & checkSquare)
-                    break;
-                r2++;
-            }
-
-            fwrite(&mask, sizeof(mask), 1, of);
-
-            /*if (i < numBoards - 1)
-                fprintf(of, "0x%" PRIX64 ",", mask);
-            else
-                fprintf(of, "0x%" PRIX64, mask);*/
-        }
-
-        /*if (square < 63)
-            fprintf(of, " },\n");
-        else
-            fprintf(of, "}\n");*/
     }
+    return attacks;
+}
 
-    //fprintf(of, "};\n");
-
-    fclose(of);
-
-    printf("\n\n");
-
-    return 0;
+static void PrintIndices(FILE * of, const char * name, const uint16_t * indices, size_t length)
+{
+    fprintf(of, "const uint16_t %s[%zu] =\n{\n", name, length);
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (i % 24 == 0)
+            fputs("    ", of);
+        fprintf(of, "%u", indices[i]);
+        if (i < length - 1)
+            fputs((i % 24 == 23) ? ",\n" : ",", of);
+    }
+    fputs("\n};\n\n", of);
 }
 
-int GenerateBishopBlockerBitboards()
+static int GenerateSliderAttacks(FILE * of, const char * piece, const uint64_t * blockerMasks, const uint64_t * magics, const uint8_t * indexBits, const int directions[4][2])
 {
-    FILE * of = fopen("bishopBlockerBitboards.bin", "wb");
-    if (of == NULL)
+    size_t length = 0;
+    for (Square square = 0; square < NUM_SQUARES; ++square)
+        length += 1ull << indexBits[square];
+
+    uint64_t * pool = (uint64_t *) malloc(length * sizeof(uint64_t));
+    uint16_t * pextIndices = (uint16_t *) calloc(length, sizeof(uint16_t));
+    uint16_t * magicIndices = (uint16_t *) calloc(length, sizeof(uint16_t));
+    if (!pool || !pextIndices || !magicIndices)
         return 1;
 
-    for (Square square = 0; square < 64; ++square)
+    size_t poolLength = 0;
+    size_t offset = 0;
+    for (Square square = 0; square < NUM_SQUARES; ++square)
     {
-        File f;
-        Rank r;
-
-        EncodedSquare combined = 0;
-        EncodedSquare checkSquare = 0;
-
-        f = SquareGetFile(square);
-        r = SquareGetRank(square);
-        while (f-- > FileB && r-- > Rank2)
-        {
-            combined |= SquareEncodeRankFile(r, f);
-        }
-
-        f = SquareGetFile(square) + 1;
-        r = SquareGetRank(square);
-        while (f <= FileG && r-- > Rank2)
-        {
-            combined |= SquareEncodeRankFile(r, f);
-            f++;
-        }
+        // Attack sets from different squares never match, so only the current square's part of the pool is searched.
+        size_t squarePoolStart = poolLength;
 
-        f = SquareGetFile(square);
-        r = SquareGetRank(square) + 1;
-        while (f-- > FileB && r <= Rank7)
+        // Carry-rippler enumeration; the n-th subset is the one whose PEXT index is n.
+        uint64_t subset = 0;
+        size_t pextIndex = 0;
+        do
         {
-            combined |= SquareEncodeRankFile(r, f);
-            r++;
-        }
-
-        f = SquareGetFile(square) + 1;
-        r = SquareGetRank(square) + 1;
-        while (f <= FileG && r <= Rank7)
-        {
-            combined |= SquareEncodeRankFile(r, f);
-            r++;
-            f++;
-        }
-
-        printf("\t0x%016" PRIx64 "\n", combined);
-
-        //fprintf(of, "{ ");
-
-        uint64_t numBits = intrinsic_popcnt64(combined);
-        uint64_t numBoards = 1ull << numBits;
-        for (uint64_t i = 0; i < numBoards; ++i)
-        {
-            uint64_t bitboard = intrinsic_pext64(i, combined);
-            uint64_t mask = 0;
-
-            f = SquareGetFile(square);
-            r = SquareGetRank(square);
-            while (f-- > FileA && r-- > Rank1)
-            {
-                checkSquare = SquareEncodeRankFile(r, f);
-                mask |= checkSquare;
-                if (bitboard & checkSquare)
-                    break;
-            }
-
-            f = SquareGetFile(square) + 1;
-            r = SquareGetRank(square);
-            while (f <= FileH && r-- > Rank1)
-            {
-                checkSquare = SquareEncodeRankFile(r, f);
-                mask |= checkSquare;
-                if (bitboard & checkSquare)
-                    break;
-                f++;
-            }
-
-            f = SquareGetFile(square);
-            r = SquareGetRank(square) + 1;
-            while (f-- > FileA && r <= Rank8)
-            {
-                checkSquare = SquareEncodeRankFile(r, f);
-                mask |= checkSquare;
-                if (bitboard & checkSquare)
-                    break;
-                r++;
-            }
-
-            f = SquareGetFile(square) + 1;
-            r = SquareGetRank(square) + 1;
-            while (f <= FileH && r <= Rank8)
-            {
-                checkSquare = SquareEncodeRankFile(r, f);
-                mask |= checkSquare;
-                if (bitboard & checkSquare)
-                    break;
-                r++;
-                f++;
-            }
-
-            fwrite(&mask, sizeof(mask), 1, of);
-
-            /*if (i < numBoards - 1)
-                fprintf(of, "0x%" PRIX64 ",", mask);
-            else
-                fprintf(of, "0x%" PRIX64, mask);*/
-        }
-
-        /*if (square < 63)
-            fprintf(of, " },\n");
-        else
-            fprintf(of, "}\n");*/
+            uint64_t attacks = SlidingAttacks(square, subset, directions);
+            size_t k = squarePoolStart;
+            while (k < poolLength && pool[k] != attacks)
+                k++;
+            if (k == poolLength)
+                pool[poolLength++] = attacks;
+            if (k > UINT16_MAX)
+                return 1;
+
+            size_t magicIndex = (size_t) ((subset * magics[square]) >> (64 - indexBits[square]));
+            pextIndices[offset + pextIndex] = (uint16_t) k;
+            magicIndices[offset + magicIndex] = (uint16_t) k;
+
+            subset = (subset - blockerMasks[square]) & blockerMasks[square];
+            pextIndex++;
+        } while (subset != 0);
+
+        if (pextIndex != (1ull << indexBits[square]))
+            return 1;
+
+        offset += pextIndex;
     }
 
-    //fprintf(of, "};\n");
+    char name[64];
+    snprintf(name, sizeof(name), "s_%sAttackPool", piece);
+    fprintf(of, "const uint64_t %s[%zu] =\n{\n", name, poolLength);
+    for (size_t i = 0; i < poolLength; ++i)
+        fprintf(of, "    0x%016" PRIx64 "%s\n", pool[i], (i < poolLength - 1) ? "," : "");
+    fputs("};\n\n", of);
 
-    fclose(of);
+    snprintf(name, sizeof(name), "s_%sPextAttackIndices", piece);
+    PrintIndices(of, name, pextIndices, length);
+    snprintf(name, sizeof(name), "s_%sMagicAttackIndices", piece);
+    PrintIndices(of, name, magicIndices, length);
 
-    printf("\n\n");
+    printf("%s: %zu indices, %zu unique attack sets\n", piece, length, poolLength);
 
+    free(pool);
+    free(pextIndices);
+    free(magicIndices);
     return 0;
 }
 
 int main(int argc, char ** argv)
 {
-    int result = GenerateRookBlockerBitboards();
-    if (result != 0)
-        return result;
-    return GenerateBishopBlockerBitboards();
+    static const int rookDirections[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+    static const int bishopDirections[4][2] = { { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
+
+    FILE * of = fopen("SliderAttacks.c", "w");
+    if (of == NULL)
+        return 1;
+
+    fputs("#include \"SliderAttacks.h\"\n\n// Auto-generated by tools/BitboardGeneration.c.\n", of);
+
+    int result = GenerateSliderAttacks(of, "rook", s_rookBlockerMasks, s_rookMagics, s_rookBlockerIndexBits, rookDirections);
+    if (result == 0)
+        result = GenerateSliderAttacks(of, "bishop", s_bishopBlockerMasks, s_bishopMagics, s_bishopBlockerIndexBits, bishopDirections);
+
+    fclose(of);
+    return result;
 }
@@ -1,7 +1,12 @@
+#include "Board.h"
+#include "FEN.h"
+#include "Init.h"
 #include "Intrinsics.h"
+#include "MoveGeneration.h"
 #include "Square.h"
 
 #include <stdint.h>
+#include <stdio.h>
 #include <time.h>
 
 //#define BITBOARD_SPEED_TESTS
@@ -67,8 +72,86 @@ EncodedSquare CachelessBitboard(EncodedSquare occ, Square square)
         _blsmsk_u64(occ & Masks3[square].mask4) & Masks3[square].mask4;
 }
 
+// Compares the union of all slider attacks of one side, summed from per-square table lookups (with the current slider
+// backend), against the set-wise Kogge-Stone fills. Uses the real attack tables, so this links against the engine.
+static void SetwiseSliderSpeedTest()
+{
+    static const char * fens[] =
+    {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "2r3k1/5pp1/p3p2p/1p1bP3/3B4/P4Q2/1q3PPP/3R2K1 b - - 0 30",
+        "6k1/5p2/6p1/8/7p/8/6PP/6K1 b - - 0 1",
+    };
+    static const int numFens = sizeof(fens) / sizeof(fens[0]);
+
+    EncodedSquare bishops[2 * sizeof(fens) / sizeof(fens[0])];
+    EncodedSquare rooks[2 * sizeof(fens) / sizeof(fens[0])];
+    EncodedSquare occupancy[2 * sizeof(fens) / sizeof(fens[0])];
+    int numPositions = 0;
+    for (int i = 0; i < numFens; ++i)
+    {
+        Board board;
+        if (!ParseFEN(fens[i], &board))
+            continue;
+        for (Player player = White; player <= Black; ++player)
+        {
+            bishops[numPositions] = BoardGetPlayerPieceTable(&board, player, PIECE_TABLE_BISHOPS_QUEENS);
+            rooks[numPositions] = BoardGetPlayerPieceTable(&board, player, PIECE_TABLE_ROOKS_QUEENS);
+            occupancy[numPositions] = BoardGetOccupancy(&board);
+            numPositions++;
+        }
+    }
+
+    static const int numCycles = 10000000;
+
+    uint64_t sum = 0;
+    clock_t begin;
+    clock_t end;
+
+    begin = clock();
+    for (int cycles = 0; cycles < numCycles; cycles++)
+    {
+        for (int i = 0; i < numPositions; ++i)
+        {
+            EncodedSquare occ = occupancy[i] ^ (cycles & 1); // Keeps the compiler from hoisting the lookups out of the loop.
+            EncodedSquare attacks = 0;
+            for (EncodedSquare pieces = bishops[i]; pieces; pieces = intrinsic_blsr64(pieces))
+                attacks |= GetBishopMoves(occ, SquareDecodeLowest(pieces));
+            for (EncodedSquare pieces = rooks[i]; pieces; pieces = intrinsic_blsr64(pieces))
+                attacks |= GetRookMoves(occ, SquareDecodeLowest(pieces));
+            sum += attacks;
+        }
+    }
+    end = clock();
+    printf("Per-square slider lookups duration: %f seconds\n", (float) (end - begin) / CLOCKS_PER_SEC);
+
+    begin = clock();
+    for (int cycles = 0; cycles < numCycles; cycles++)
+    {
+        for (int i = 0; i < numPositions; ++i)
+        {
+            EncodedSquare occ = occupancy[i] ^ (cycles & 1);
+            sum += GetSetwiseBishopMoves(bishops[i], occ) | GetSetwiseRookMoves(rooks[i], occ);
+        }
+    }
+    end = clock();
+    printf("Set-wise slider fills duration: %f seconds\n", (float) (end - begin) / CLOCKS_PER_SEC);
+
+    printf("Blah %u\n", (int) sum);
+}
+
 int main(int argc, char ** argv)
 {
+    if (Init() != 0)
+        return 1;
+
+    SetwiseSliderSpeedTest();
+
     static uint64_t magicLookupFull[64][4096];
 
     for (uint64_t i = 0; i < 64; ++i)
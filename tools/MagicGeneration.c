@@ -0,0 +1,95 @@
+#include "Intrinsics.h"
+#include "Random.h"
+#include "Square.h"
+#include "tables/MoveTables.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+//#define MAGIC_GENERATION
+
+// Walks each ray from the given square until (and including) the first blocker.
+static uint64_t SlidingAttacks(Square square, uint64_t occupied, const int directions[4][2])
+{
+    uint64_t attacks = 0;
+    for (int d = 0; d < 4; ++d)
+    {
+        int r = (int) SquareGetRank(square) + directions[d][0];
+        int f = (int) SquareGetFile(square) + directions[d][1];
+        while (r >= Rank1 && r <= Rank8 && f >= FileA && f <= FileH)
+        {
+            EncodedSquare s = SquareEncodeRankFile((Rank) r, (File) f);
+            attacks |= s;
+            if (occupied & s)
+                break;
+            r += directions[d][0];
+            f += directions[d][1];
+        }
+    }
+    return attacks;
+}
+
+// Finds a multiplier which maps every subset of the blocker mask to a slot in a table of 2^bits entries without a
+// destructive collision; i.e. two subsets may only share a slot if they produce the same attack set. The number of
+// bits is the same as the PEXT index width, so both backends use tables of identical size.
+static uint64_t FindMagic(Square square, uint64_t mask, const int directions[4][2])
+{
+    static uint64_t occupancies[4096];
+    static uint64_t attacks[4096];
+    static uint64_t used[4096];
+
+    int bits = intrinsic_popcnt64(mask);
+    int numSubsets = 1 << bits;
+
+    // Carry-rippler enumeration; the n-th subset is the one whose PEXT index is n.
+    uint64_t subset = 0;
+    for (int i = 0; i < numSubsets; ++i)
+    {
+        occupancies[i] = subset;
+        attacks[i] = SlidingAttacks(square, subset, directions);
+        subset = (subset - mask) & mask;
+    }
+
+    for (;;)
+    {
+        uint64_t magic = RandomU64() & RandomU64() & RandomU64();
+        if (intrinsic_popcnt64((mask * magic) >> 56) < 6)
+            continue;
+
+        memset(used, 0, sizeof(uint64_t) * numSubsets);
+        bool fail = false;
+        for (int i = 0; i < numSubsets && !fail; ++i)
+        {
+            uint64_t index = (occupancies[i] * magic) >> (64 - bits);
+            if (used[index] == 0)
+                used[index] = attacks[i];
+            else if (used[index] != attacks[i])
+                fail = true;
+        }
+
+        if (!fail)
+            return magic;
+    }
+}
+
+static void PrintMagics(const char * name, const uint64_t * masks, const int directions[4][2])
+{
+    printf("const uint64_t %s[NUM_SQUARES] =\n{\n", name);
+    for (Square square = 0; square < NUM_SQUARES; ++square)
+    {
+        uint64_t magic = FindMagic(square, masks[square], directions);
+        printf("    0x%016" PRIx64 "%s\n", magic, (square < NUM_SQUARES - 1) ? "," : "");
+    }
+    printf("};\n\n");
+}
+
+int main(int argc, char ** argv)
+{
+    static const int rookDirections[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+    static const int bishopDirections[4][2] = { { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
+
+    PrintMagics("s_rookMagics", s_rookBlockerMasks, rookDirections);
+    PrintMagics("s_bishopMagics", s_bishopBlockerMasks, bishopDirections);
+    return 0;
+}
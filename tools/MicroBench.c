@@ -0,0 +1,353 @@
+#include "Bench.h"
+#include "Board.h"
+#include "FEN.h"
+#include "Init.h"
+#include "Intrinsics.h"
+#include "KillerMove.h"
+#include "Move.h"
+#include "MoveGeneration.h"
+#include "MoveOrderer.h"
+#include "Random.h"
+#include "StaticEval.h"
+#include "Syzygy.h"
+#include "Timer.h"
+#include "Transposition.h"
+#include "Zobrist.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Micro-benchmarks for the primitives on the hot path of the search. Every primitive is timed over the same set of
+// positions, collected by random playouts from the bench positions, so that branch predictors and caches see a
+// realistic mix rather than one position over and over. Each measurement is repeated and the median and 95th
+// percentile are reported in nanoseconds per operation.
+
+#define MAX_SAMPLES 8192
+#define MAX_PLAYOUT_PLIES 160
+#define MAX_SAMPLE_MOVES (MAX_SAMPLES * 64)
+
+#define NUM_WARMUP_REPETITIONS 3
+#define NUM_REPETITIONS 25
+
+// Each repetition runs the operation over all samples as many times as needed to take at least this long, so that the
+// microsecond timer resolution does not matter.
+#define MIN_REPETITION_TIME_US 2000
+
+#define NUM_TT_KEYS 0x100000
+
+typedef struct
+{
+    uint32_t movesOffset;
+    uint8_t numMoves;
+    Move legalMove; // A legal move, for MakeMove.
+    Move pseudoLegalMove; // A pseudo-legal move which may leave the king in check, for IsMoveValid.
+} Sample;
+
+static Board s_boards[MAX_SAMPLES];
+static Sample s_samples[MAX_SAMPLES];
+static AttackMap s_attackMaps[MAX_SAMPLES];
+static Move s_sampleMoves[MAX_SAMPLE_MOVES];
+static uint32_t s_numSamples = 0;
+static uint32_t s_numSampleMoves = 0;
+
+static uint32_t s_syzygySamples[MAX_SAMPLES];
+static uint32_t s_numSyzygySamples = 0;
+
+static uint64_t * s_ttKeys = NULL;
+
+// Results are accumulated here so that the compiler cannot discard the work being timed.
+static volatile uint64_t s_sink = 0;
+
+typedef uint64_t (*BenchFunction)(uint32_t index);
+
+static bool AddSample(const Board * board)
+{
+    if (s_numSamples >= MAX_SAMPLES)
+        return false;
+
+    Move moves[256];
+    uint8_t numLegalMoves = GetValidMoves(board, moves);
+    if (numLegalMoves == 0)
+        return false;
+    Move legalMove = moves[RandomU64() % numLegalMoves];
+
+    uint8_t numMoves = GetPseudoLegalMoves(board, moves);
+    if (s_numSampleMoves + numMoves > MAX_SAMPLE_MOVES)
+        return false;
+
+    Sample * sample = &s_samples[s_numSamples];
+    sample->movesOffset = s_numSampleMoves;
+    sample->numMoves = numMoves;
+    sample->legalMove = legalMove;
+    sample->pseudoLegalMove = moves[RandomU64() % numMoves];
+    memcpy(&s_sampleMoves[s_numSampleMoves], moves, numMoves * sizeof(Move));
+    s_numSampleMoves += numMoves;
+
+    s_boards[s_numSamples] = *board;
+    AttackMapInitialize(&s_attackMaps[s_numSamples], board, !board->playerToMove);
+
+    if (intrinsic_popcnt64(BoardGetOccupancy(board)) <= MaxCardinality && board->castleBits == 0)
+        s_syzygySamples[s_numSyzygySamples++] = s_numSamples;
+
+    s_numSamples++;
+    return true;
+}
+
+static bool CollectSamples()
+{
+    RandomSeed(1070372);
+
+    size_t numPositions = BenchGetNumPositions();
+    uint32_t samplesPerPosition = MAX_SAMPLES / (uint32_t)numPositions;
+    for (size_t i = 0; i < numPositions; ++i)
+    {
+        Board start;
+        if (!ParseFEN(BenchGetPosition(i), &start))
+        {
+            printf("Invalid bench position: %s\n", BenchGetPosition(i));
+            return false;
+        }
+
+        // Several playouts per bench position, each one sampling every position along the way, so that the set covers
+        // openings, middlegames and endgames.
+        uint32_t target = (uint32_t)(i + 1) * samplesPerPosition;
+        while (s_numSamples < target)
+        {
+            Board board = start;
+            uint32_t ply = 0;
+            for (; ply < MAX_PLAYOUT_PLIES && s_numSamples < target; ++ply)
+            {
+                if (!AddSample(&board))
+                    break;
+                MakeMove(&board, s_samples[s_numSamples - 1].legalMove);
+            }
+
+            // Out of storage, or the bench position itself has no moves.
+            if (ply == 0)
+                break;
+        }
+    }
+
+    return s_numSamples > 0;
+}
+
+static uint64_t BenchMakeMove(uint32_t index)
+{
+    Board board = s_boards[index];
+    MakeMove(&board, s_samples[index].legalMove);
+    return board.hash;
+}
+
+static uint64_t BenchIsMoveValid(uint32_t index)
+{
+    return IsMoveValid(&s_boards[index], s_samples[index].pseudoLegalMove);
+}
+
+static uint64_t BenchKingIsAttacked(uint32_t index)
+{
+    return KingIsAttacked(&s_boards[index], s_boards[index].playerToMove);
+}
+
+static uint64_t BenchGetPseudoLegalMoves(uint32_t index)
+{
+    Move moves[256];
+    return GetPseudoLegalMoves(&s_boards[index], moves);
+}
+
+static uint64_t BenchGetPseudoLegalCaptures(uint32_t index)
+{
+    Move moves[256];
+    return GetPseudoLegalCaptures(&s_boards[index], moves);
+}
+
+static uint64_t BenchEvaluate(uint32_t index)
+{
+    return (uint64_t)Evaluate(&s_boards[index]);
+}
+
+static uint64_t BenchAttackMapInitialize(uint32_t index)
+{
+    AttackMap attackMap;
+    AttackMapInitialize(&attackMap, &s_boards[index], !s_boards[index].playerToMove);
+    return attackMap.all;
+}
+
+static uint64_t BenchMoveOrdererInitialize(uint32_t index)
+{
+    MoveOrderer moveOrderer;
+    uint32_t keys[256];
+    KillerMoves killers;
+    KillerMoveInitialize(&killers);
+    Move ttMove = { 0 };
+    const Sample * sample = &s_samples[index];
+    MoveOrdererInitialize(&moveOrderer, &s_boards[index], &s_sampleMoves[sample->movesOffset], keys, sample->numMoves, &s_attackMaps[index], 0, NULL, &killers, ttMove);
+    return keys[0];
+}
+
+static uint64_t BenchZobristCalculate(uint32_t index)
+{
+    return ZobristCalculate(&s_boards[index]);
+}
+
+static uint64_t BenchSyzygyProbeWDL(uint32_t index)
+{
+    ProbeState result;
+    WDLScore score = SyzygyProbeWDL(&s_boards[s_syzygySamples[index]], &result);
+    return (uint64_t)(score + result);
+}
+
+static TranspositionTable s_tt;
+
+static uint64_t BenchTTInsert(uint32_t index)
+{
+    uint64_t key = s_ttKeys[index];
+    TranspositionTableInsert(&s_tt, key, (EncodedMove)key, (int32_t)(key >> 48) - 0x8000, (int32_t)(key >> 40) & 0x3F, TranspositionExact);
+    return 0;
+}
+
+static uint64_t BenchTTProbe(uint32_t index)
+{
+    EncodedMove move;
+    int32_t eval;
+    int32_t depth;
+    return TranspositionTableLookup(&s_tt, s_ttKeys[index], &move, &eval, &depth);
+}
+
+static int CompareDouble(const void * a, const void * b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static uint64_t RunPass(BenchFunction function, uint32_t numOperations, uint32_t numPasses)
+{
+    uint64_t sink = 0;
+    uint64_t start = TimerGetMicroseconds();
+    for (uint32_t pass = 0; pass < numPasses; ++pass)
+    {
+        for (uint32_t i = 0; i < numOperations; ++i)
+            sink += function(i);
+    }
+    uint64_t elapsed = TimerGetMicroseconds() - start;
+    s_sink += sink;
+    return elapsed;
+}
+
+static void RunBenchmark(const char * name, BenchFunction function, uint32_t numOperations)
+{
+    if (numOperations == 0)
+    {
+        printf("%-32s skipped\n", name);
+        return;
+    }
+
+    // Warm up caches and branch predictors, and work out how many passes make a repetition long enough to time.
+    uint32_t numPasses = 1;
+    for (int i = 0; i < NUM_WARMUP_REPETITIONS; ++i)
+    {
+        uint64_t elapsed = RunPass(function, numOperations, numPasses);
+        while (elapsed < MIN_REPETITION_TIME_US && numPasses < 0x10000)
+        {
+            numPasses *= 2;
+            elapsed = RunPass(function, numOperations, numPasses);
+        }
+    }
+
+    double results[NUM_REPETITIONS];
+    for (int i = 0; i < NUM_REPETITIONS; ++i)
+    {
+        uint64_t elapsed = RunPass(function, numOperations, numPasses);
+        results[i] = (elapsed * 1000.0) / ((double)numOperations * numPasses);
+    }
+
+    qsort(results, NUM_REPETITIONS, sizeof(double), CompareDouble);
+    double median = results[NUM_REPETITIONS / 2];
+    double p95 = results[(NUM_REPETITIONS * 95 + 99) / 100 - 1];
+    printf("%-32s %10.2f %10.2f %10" PRIu32 "\n", name, median, p95, numOperations);
+}
+
+static void RunTranspositionTableBenchmarks(size_t sizeMB)
+{
+    if (!TranspositionTableInitialize(&s_tt, TranspositionTableConvertNumBuckets(sizeMB)))
+    {
+        printf("Failed to allocate a %zu MB transposition table\n", sizeMB);
+        return;
+    }
+
+    char name[64];
+    snprintf(name, sizeof(name), "TT insert (%zu MB)", sizeMB);
+    RunBenchmark(name, BenchTTInsert, NUM_TT_KEYS);
+
+    // The table is full of the keys now, so most probes hit (small tables will have evicted some of them).
+    snprintf(name, sizeof(name), "TT probe (%zu MB)", sizeMB);
+    RunBenchmark(name, BenchTTProbe, NUM_TT_KEYS);
+
+    TranspositionTableDestroy(&s_tt);
+}
+
+int main(int argc, char ** argv)
+{
+    (void)argc;
+    (void)argv;
+
+    if (Init() != 0)
+    {
+        puts("Initialization failed");
+        return 1;
+    }
+    ZobristGenerate();
+
+#if defined(_MSC_VER)
+    bool syzygyInitialized = SyzygyInit(".;syzygy\\3-4-5-dtz-nr;syzygy\\3-4-5-wdl;..\\..\\syzygy\\3-4-5-dtz-nr;..\\..\\syzygy\\3-4-5-wdl");
+#else
+    bool syzygyInitialized = SyzygyInit(".:syzygy/3-4-5-dtz-nr:syzygy/3-4-5-wdl:../../syzygy/3-4-5-dtz-nr:../../syzygy/3-4-5-wdl");
+#endif
+
+    if (!CollectSamples())
+    {
+        Cleanup();
+        return 1;
+    }
+
+    s_ttKeys = (uint64_t *)malloc(NUM_TT_KEYS * sizeof(uint64_t));
+    if (s_ttKeys == NULL)
+    {
+        Cleanup();
+        return 1;
+    }
+    for (uint32_t i = 0; i < NUM_TT_KEYS; ++i)
+    {
+        do
+        {
+            s_ttKeys[i] = RandomU64();
+        } while (s_ttKeys[i] == 0);
+    }
+
+    printf("Samples: %" PRIu32 " positions, %" PRIu32 " tablebase positions\n\n", s_numSamples, s_numSyzygySamples);
+    printf("%-32s %10s %10s %10s\n", "Benchmark", "median ns", "p95 ns", "ops/pass");
+
+    RunBenchmark("MakeMove", BenchMakeMove, s_numSamples);
+    RunBenchmark("IsMoveValid", BenchIsMoveValid, s_numSamples);
+    RunBenchmark("KingIsAttacked", BenchKingIsAttacked, s_numSamples);
+    RunBenchmark("GetPseudoLegalMoves", BenchGetPseudoLegalMoves, s_numSamples);
+    RunBenchmark("GetPseudoLegalCaptures", BenchGetPseudoLegalCaptures, s_numSamples);
+    RunBenchmark("Evaluate", BenchEvaluate, s_numSamples);
+    RunBenchmark("AttackMapInitialize", BenchAttackMapInitialize, s_numSamples);
+    RunBenchmark("MoveOrdererInitialize", BenchMoveOrdererInitialize, s_numSamples);
+    RunBenchmark("ZobristCalculate", BenchZobristCalculate, s_numSamples);
+    RunBenchmark("SyzygyProbeWDL", BenchSyzygyProbeWDL, syzygyInitialized ? s_numSyzygySamples : 0);
+
+    // Small tables stay mostly in cache; large ones miss on nearly every access, like the search does.
+    RunTranspositionTableBenchmarks(4);
+    RunTranspositionTableBenchmarks(64);
+    RunTranspositionTableBenchmarks(512);
+
+    free(s_ttKeys);
+    if (syzygyInitialized)
+        SyzygyDestroy();
+    Cleanup();
+    return 0;
+}
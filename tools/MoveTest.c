@@ -20,12 +20,12 @@ static Move s_moves[65536]; // Probably excessive, but whatever.
 void PrintBoard(const Board * b)
 {
     for (int i = 0; i < NUM_PIECE_TABLES; ++i)
-        printf("0x%016" PRIx64 "\n", b->whitePieceTables[i]);
+        printf("0x%016" PRIx64 "\n", BoardGetPlayerPieceTable(b, White, i));
     for (int i = 0; i < NUM_PIECE_TABLES; ++i)
-        printf("0x%016" PRIx64 "\n", b->blackPieceTables[i]);
+        printf("0x%016" PRIx64 "\n", BoardGetPlayerPieceTable(b, Black, i));
     printf("%" PRIu8 "\n", b->whiteKingSquare);
     printf("%" PRIu8 "\n", b->blackKingSquare);
-    printf("%" PRIu64 "\n", b->allPieceTables);
+    printf("%" PRIu64 "\n", BoardGetOccupancy(b));
     printf("%" PRIu8 "\n", b->enPassantSquare);
 }
 
@@ -207,7 +207,7 @@ bool perft(const char * fen, uint64_t depth, const uint64_t * compare)
 
 int main(int argc, char ** argv)
 {
-    int result = Init(NULL);
+    int result = Init();
     if (result != 0)
         return result;
 
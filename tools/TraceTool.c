@@ -0,0 +1,391 @@
+#include "MemoryMappedFile.h"
+#include "Move.h"
+#include "PieceType.h"
+#include "SearchStats.h"
+#include "SearchTrace.h"
+#include "Square.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Reads a search trace written with SEARCH_TRACE enabled (see SearchTrace.h), rebuilds the search tree from it and
+// prints either a summary of the pruning decisions per depth, or selected subtrees.
+//
+//   trace-tool <file> summary
+//   trace-tool <file> tree [--iteration K] [--path move...] [--levels N] [--reason R]
+//
+// Records are written in post-order, so a node comes after all of its children; a node's children are the records
+// one ply deeper which were written since the previous record at the node's ply or above. The oldest records may have
+// been overwritten by the ring, in which case the oldest subtrees in the file are incomplete.
+
+#define DEFAULT_LEVELS 2
+
+static const char * s_reasonNames[NUM_TRACE_REASONS] =
+{
+    "searched",
+    "cutoff",
+    "aborted",
+    "draw",
+    "repetition",
+    "ttcutoff",
+    "tablebase",
+    "futility",
+    "rfutility",
+    "nullmove",
+    "nomoves",
+    "standpat"
+};
+
+static const char * s_nodeTypeNames[NUM_SEARCH_NODE_TYPES] =
+{
+    "pv",
+    "nonpv",
+    "qs"
+};
+
+typedef struct
+{
+    const TraceRecord * records; // Oldest first.
+    uint64_t numRecords;
+    int32_t * firstChild;
+    int32_t * nextSibling;
+    int32_t * roots;             // Records without a parent in the file, oldest first: one per iteration of each search.
+    int32_t numRoots;
+} TraceTree;
+
+static MemoryMappedFile s_file;
+
+static void MoveString(EncodedMove encodedMove, uint8_t flags, char * str)
+{
+    if (flags & TRACE_FLAG_NULL_MOVE)
+    {
+        strcpy(str, "null");
+        return;
+    }
+    if (!EncodedMoveValid(encodedMove))
+    {
+        strcpy(str, "root");
+        return;
+    }
+
+    static const char s_promotions[] = { ' ', ' ', 'n', 'b', 'r', 'q', ' ', ' ' };
+    Move move = MoveDecode(encodedMove);
+    str[0] = (char)('a' + SquareGetFile(move.from));
+    str[1] = (char)('1' + SquareGetRank(move.from));
+    str[2] = (char)('a' + SquareGetFile(move.to));
+    str[3] = (char)('1' + SquareGetRank(move.to));
+    str[4] = (move.promotion != None) ? s_promotions[move.promotion & 7] : '\0';
+    str[5] = '\0';
+}
+
+static void FlagsString(uint8_t flags, char * str)
+{
+    str[0] = '\0';
+    if (flags & TRACE_FLAG_NULL_MOVE)
+        strcat(str, ",null");
+    if (flags & TRACE_FLAG_REDUCED)
+        strcat(str, ",lmr");
+    if (flags & TRACE_FLAG_ZERO_WINDOW)
+        strcat(str, ",zw");
+    if (flags & TRACE_FLAG_RESEARCH)
+        strcat(str, ",research");
+    if (str[0] == '\0')
+        strcpy(str, ",-");
+    memmove(str, str + 1, strlen(str));
+}
+
+static int ParseReason(const char * name)
+{
+    for (int reason = 0; reason < NUM_TRACE_REASONS; ++reason)
+    {
+        if (strcmp(name, s_reasonNames[reason]) == 0)
+            return reason;
+    }
+    return -1;
+}
+
+static bool TraceLoad(const char * filename, TraceTree * tree)
+{
+    memset(tree, 0, sizeof(TraceTree));
+
+    MemoryMappedFileInitialize(&s_file);
+    if (!MemoryMappedFileOpen(&s_file, filename))
+    {
+        fprintf(stderr, "Could not open %s\n", filename);
+        return false;
+    }
+
+    const TraceHeader * header = (const TraceHeader *)MemoryMappedFileGetAddress(&s_file);
+    if (MemoryMappedFileGetSize(&s_file) < sizeof(TraceHeader) ||
+        header->magic != SEARCH_TRACE_MAGIC ||
+        header->version != SEARCH_TRACE_VERSION ||
+        header->recordSize != sizeof(TraceRecord) ||
+        MemoryMappedFileGetSize(&s_file) < sizeof(TraceHeader) + (uint64_t)header->capacity * sizeof(TraceRecord))
+    {
+        fprintf(stderr, "%s is not a search trace, or was written by a different version\n", filename);
+        return false;
+    }
+
+    // Copy the ring out oldest first, so the rest of the tool can ignore the wrap around.
+    const TraceRecord * ring = (const TraceRecord *)(header + 1);
+    uint64_t numRecords = (header->numRecords < header->capacity) ? header->numRecords : header->capacity;
+    uint64_t start = header->numRecords - numRecords;
+    TraceRecord * records = (TraceRecord *)malloc((numRecords + 1) * sizeof(TraceRecord));
+    tree->firstChild = (int32_t *)malloc((numRecords + 1) * sizeof(int32_t));
+    tree->nextSibling = (int32_t *)malloc((numRecords + 1) * sizeof(int32_t));
+    tree->roots = (int32_t *)malloc((numRecords + 1) * sizeof(int32_t));
+    int32_t * stack = (int32_t *)malloc((numRecords + 1) * sizeof(int32_t));
+    if (records == NULL || tree->firstChild == NULL || tree->nextSibling == NULL || tree->roots == NULL || stack == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        free(records);
+        free(stack);
+        return false;
+    }
+    for (uint64_t i = 0; i < numRecords; ++i)
+        records[i] = ring[(start + i) & (header->capacity - 1)];
+    tree->records = records;
+    tree->numRecords = numRecords;
+
+    // Every record on the stack is still waiting for its parent. Children are popped newest first, so prepending each
+    // one to the child list leaves the list in search order.
+    int32_t stackSize = 0;
+    for (int32_t i = 0; i < (int32_t)numRecords; ++i)
+    {
+        tree->firstChild[i] = -1;
+        tree->nextSibling[i] = -1;
+        while (stackSize > 0 && records[stack[stackSize - 1]].ply > records[i].ply)
+        {
+            int32_t child = stack[--stackSize];
+            tree->nextSibling[child] = tree->firstChild[i];
+            tree->firstChild[i] = child;
+        }
+        stack[stackSize++] = i;
+    }
+    for (int32_t i = 0; i < stackSize; ++i)
+        tree->roots[tree->numRoots++] = stack[i];
+
+    free(stack);
+    return true;
+}
+
+static void TraceFree(TraceTree * tree)
+{
+    free((void *)tree->records);
+    free(tree->firstChild);
+    free(tree->nextSibling);
+    free(tree->roots);
+    MemoryMappedFileClose(&s_file);
+}
+
+static int Summary(const TraceTree * tree)
+{
+    // Rows are remaining depths 0 to SEARCH_STATS_MAX_DEPTH - 1; quiescence nodes all go in row 0.
+    static uint64_t s_reasons[SEARCH_STATS_MAX_DEPTH][NUM_TRACE_REASONS];
+    static uint64_t s_nodes[SEARCH_STATS_MAX_DEPTH];
+    static uint64_t s_reduced[SEARCH_STATS_MAX_DEPTH];
+    static uint64_t s_reducedFailHigh[SEARCH_STATS_MAX_DEPTH];
+    uint64_t nodeTypes[NUM_SEARCH_NODE_TYPES] = { 0 };
+    uint64_t flags[4] = { 0 };
+
+    for (uint64_t i = 0; i < tree->numRecords; ++i)
+    {
+        const TraceRecord * record = &tree->records[i];
+        int depth = (record->nodeType == SearchNodeQuiescence || record->depth < 0) ? 0 : record->depth;
+        if (depth >= SEARCH_STATS_MAX_DEPTH)
+            depth = SEARCH_STATS_MAX_DEPTH - 1;
+
+        s_nodes[depth]++;
+        if (record->reason < NUM_TRACE_REASONS)
+            s_reasons[depth][record->reason]++;
+        if (record->nodeType < NUM_SEARCH_NODE_TYPES)
+            nodeTypes[record->nodeType]++;
+        for (int flag = 0; flag < 4; ++flag)
+            flags[flag] += (record->flags >> flag) & 1;
+
+        // A reduced node which does not fail low (from the parent's point of view) costs a search at full depth.
+        if (record->flags & TRACE_FLAG_REDUCED)
+        {
+            s_reduced[depth]++;
+            s_reducedFailHigh[depth] += (record->score < record->beta);
+        }
+    }
+
+    printf("records %" PRIu64 " iterations %i pv %" PRIu64 " nonpv %" PRIu64 " qs %" PRIu64 "\n",
+           tree->numRecords, tree->numRoots, nodeTypes[SearchNodePV], nodeTypes[SearchNodeNonPV], nodeTypes[SearchNodeQuiescence]);
+    printf("flags null %" PRIu64 " lmr %" PRIu64 " zw %" PRIu64 " research %" PRIu64 "\n", flags[0], flags[1], flags[2], flags[3]);
+
+    printf("%5s %10s", "depth", "nodes");
+    for (int reason = 0; reason < NUM_TRACE_REASONS; ++reason)
+        printf(" %10s", s_reasonNames[reason]);
+    printf(" %10s %10s\n", "lmr", "lmrfailhi%");
+    for (int depth = SEARCH_STATS_MAX_DEPTH - 1; depth >= 0; --depth)
+    {
+        if (s_nodes[depth] == 0)
+            continue;
+        if (depth == 0)
+            printf("%5s %10" PRIu64, "qs", s_nodes[depth]);
+        else
+            printf("%5i %10" PRIu64, depth, s_nodes[depth]);
+        for (int reason = 0; reason < NUM_TRACE_REASONS; ++reason)
+            printf(" %10" PRIu64, s_reasons[depth][reason]);
+        printf(" %10" PRIu64 " %10.1f\n", s_reduced[depth], s_reduced[depth] ? (100.0 * s_reducedFailHigh[depth]) / s_reduced[depth] : 0.0);
+    }
+    return 0;
+}
+
+static bool HasReason(const TraceTree * tree, int32_t node, int reason)
+{
+    if (reason < 0 || tree->records[node].reason == reason)
+        return true;
+    for (int32_t child = tree->firstChild[node]; child >= 0; child = tree->nextSibling[child])
+    {
+        if (HasReason(tree, child, reason))
+            return true;
+    }
+    return false;
+}
+
+static void PrintNode(const TraceTree * tree, int32_t node, int level, int levels, int reason)
+{
+    if (!HasReason(tree, node, reason))
+        return;
+
+    const TraceRecord * record = &tree->records[node];
+    char move[8];
+    char flags[32];
+    int32_t numChildren = 0;
+    for (int32_t child = tree->firstChild[node]; child >= 0; child = tree->nextSibling[child])
+        numChildren++;
+    MoveString(record->move, record->flags, move);
+    FlagsString(record->flags, flags);
+
+    printf("%*s%s ply %u depth %i %s [%i, %i] -> %i %s %s children %i hash 0x%016" PRIx64 "\n",
+           level * 2, "",
+           move,
+           record->ply,
+           record->depth,
+           (record->nodeType < NUM_SEARCH_NODE_TYPES) ? s_nodeTypeNames[record->nodeType] : "?",
+           record->alpha,
+           record->beta,
+           record->score,
+           (record->reason < NUM_TRACE_REASONS) ? s_reasonNames[record->reason] : "?",
+           flags,
+           numChildren,
+           record->hash);
+
+    if (level >= levels)
+        return;
+    for (int32_t child = tree->firstChild[node]; child >= 0; child = tree->nextSibling[child])
+        PrintNode(tree, child, level + 1, levels, reason);
+}
+
+// Prints the nodes reached by following path from node; a move may have been searched more than once (zero window
+// search, then research), so every matching child is followed.
+static void PrintPath(const TraceTree * tree, int32_t node, char ** path, int pathLength, int levels, int reason)
+{
+    if (pathLength == 0)
+    {
+        PrintNode(tree, node, 0, levels, reason);
+        return;
+    }
+
+    for (int32_t child = tree->firstChild[node]; child >= 0; child = tree->nextSibling[child])
+    {
+        char move[8];
+        MoveString(tree->records[child].move, tree->records[child].flags, move);
+        if (strcmp(move, path[0]) == 0)
+            PrintPath(tree, child, path + 1, pathLength - 1, levels, reason);
+    }
+}
+
+static int Tree(const TraceTree * tree, int argc, char ** argv)
+{
+    int iteration = tree->numRoots; // Last iteration by default.
+    int levels = DEFAULT_LEVELS;
+    int reason = -1;
+    char ** path = NULL;
+    int pathLength = 0;
+
+    for (int i = 0; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--iteration") == 0 && i + 1 < argc)
+            iteration = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--levels") == 0 && i + 1 < argc)
+            levels = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--reason") == 0 && i + 1 < argc)
+        {
+            reason = ParseReason(argv[++i]);
+            if (reason < 0)
+            {
+                fprintf(stderr, "Unknown reason %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--path") == 0)
+        {
+            path = &argv[i + 1];
+            while (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0)
+            {
+                ++i;
+                ++pathLength;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (iteration < 1 || iteration > tree->numRoots)
+    {
+        fprintf(stderr, "Iteration must be between 1 and %i\n", tree->numRoots);
+        return 1;
+    }
+
+    PrintPath(tree, tree->roots[iteration - 1], path, pathLength, levels, reason);
+    return 0;
+}
+
+static void Usage()
+{
+    fprintf(stderr, "Usage: trace-tool <file> summary\n");
+    fprintf(stderr, "       trace-tool <file> tree [--iteration K] [--path move...] [--levels N] [--reason R]\n");
+    fprintf(stderr, "Reasons:");
+    for (int reason = 0; reason < NUM_TRACE_REASONS; ++reason)
+        fprintf(stderr, " %s", s_reasonNames[reason]);
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char ** argv)
+{
+    if (argc < 3)
+    {
+        Usage();
+        return 1;
+    }
+
+    TraceTree tree;
+    if (!TraceLoad(argv[1], &tree))
+    {
+        TraceFree(&tree);
+        return 1;
+    }
+
+    int result;
+    if (strcmp(argv[2], "summary") == 0)
+        result = Summary(&tree);
+    else if (strcmp(argv[2], "tree") == 0)
+        result = Tree(&tree, argc - 3, argv + 3);
+    else
+    {
+        Usage();
+        result = 1;
+    }
+
+    TraceFree(&tree);
+    return result;
+}
@@ -1,4 +1,5 @@
 #include "Board.h"
+#include "Cuckoo.h"
 #include "Evaluation.h"
 #include "FEN.h"
 #include "KillerMove.h"
@@ -6,9 +7,12 @@
 #include "Move.h"
 #include "MoveGeneration.h"
 #include "MoveOrderer.h"
+#include "MoveTiming.h"
+#include "Perft.h"
 #include "Piece.h"
 #include "PieceType.h"
 #include "Player.h"
+#include "Random.h"
 #include "Square.h"
 #include "Repetition.h"
 #include "Sort.h"
@@ -109,7 +113,6 @@ void TestTransposition()
     ASSERT_TRUE(TranspositionTableInitialize(&table, 0x10000));
     
     EXPECT_EQ(table.numBucketsMinusOne, 0x10000 - 1);
-    EXPECT_EQ(table.utilization, 0u);
     ASSERT_NE(table.buckets, NULL);
     EXPECT_EQ(TranspositionTableGetUtilization(&table), 0u);
 
@@ -188,81 +191,128 @@ void TestTransposition()
     }
 
     TranspositionTableClear(&table);
-    EXPECT_EQ(table.utilization, 0u);
     for (size_t i = 0; i <= table.numBucketsMinusOne; ++i)
         EXPECT_EQ(table.buckets[i].length, 0u);
     EXPECT_EQ(TranspositionTableGetUtilization(&table), 0u);
+
+    // hashfull is sampled over the first TT_HASHFULL_SAMPLE_BUCKETS buckets only: fill half of those, and every bucket
+    // past them, which must not count.
+    for (uint64_t i = 0; i < 0x10000; ++i)
+    {
+        if (i < TT_HASHFULL_SAMPLE_BUCKETS && (i & 1))
+            continue;
+        for (uint64_t j = 0; j < TRANSPOSITION_TABLE_BUCKET_SIZE; ++j)
+            TranspositionTableInsert(&table, i | ((j + 1) << 32), 0, 0, 1, TranspositionExact);
+    }
+    EXPECT_EQ(TranspositionTableGetUtilization(&table), 500u);
+    TranspositionTableClear(&table);
+    EXPECT_EQ(TranspositionTableGetUtilization(&table), 0u);
     
     TranspositionTableDestroy(&table);
 }
 
 void TestRepetition()
 {
-    RepetitionTable table;
-    ASSERT_FALSE(RepetitionTableInitialize(&table, 1));
-    ASSERT_FALSE(RepetitionTableInitialize(&table, 0x8000));
-    ASSERT_FALSE(RepetitionTableInitialize(&table, 0xFFFF));
-    ASSERT_FALSE(RepetitionTableInitialize(&table, 0x10001));
-    ASSERT_TRUE(RepetitionTableInitialize(&table, 0x10000));
+    RepetitionStack stack;
+    ASSERT_FALSE(RepetitionStackInitialize(&stack, 0));
+    ASSERT_TRUE(RepetitionStackInitialize(&stack, 2));
 
-    EXPECT_EQ(table.numBucketsMinusOne, 0x10000 - 1);
-    ASSERT_NE(table.buckets, NULL);
+    EXPECT_EQ(stack.length, 0u);
+    EXPECT_EQ(stack.capacity, 2u);
+    ASSERT_NE(stack.hashes, NULL);
 
-    // Enough loop iterations to go through all possible hash buckets a couple of times.
-    uint64_t increment = (table.numBucketsMinusOne + 2);
-    uint64_t fullIteration = (table.numBucketsMinusOne + 1) * increment;
-    uint64_t end = fullIteration * (REPETITION_TABLE_BUCKET_SIZE + 2);
-    uint64_t hash = 0;
-    for (; hash < end; hash += increment)
+    // Game history which grows past the initial capacity.
+    for (uint64_t hash = 1; hash <= 10; ++hash)
     {
-        uint64_t expectedBucketLength = (hash / fullIteration) + 1;
-        RepetitionTablePush(&table, hash);
-        const RepetitionBucket * bucket = &table.buckets[hash & table.numBucketsMinusOne];
-
-        if (expectedBucketLength > REPETITION_TABLE_BUCKET_SIZE)
-        {
-            EXPECT_EQ(bucket->stackLength, REPETITION_TABLE_BUCKET_SIZE);
-            ASSERT_NE(bucket->hashListStart, NULL);
-            ASSERT_NE(bucket->hashListEnd, NULL);
-            EXPECT_EQ(bucket->hashListEnd->hash, hash);
-        }
-        else
-        {
-            EXPECT_EQ(bucket->stackLength, expectedBucketLength);
-            EXPECT_EQ(hash, bucket->hashStack[expectedBucketLength - 1]);
-        }
-        EXPECT_TRUE(RepetitionTableContains(&table, hash));
-        EXPECT_FALSE(RepetitionTableContains(&table, hash + increment));
-    }
-    hash -= increment; // This hash never actually got added because of the loop termination after increment, so account for it here.
-    for (; hash >= increment; hash -= increment)
-    {
-        uint64_t expectedBucketLength = hash / fullIteration;
-        RepetitionTablePop(&table, hash);
-        const RepetitionBucket * bucket = &table.buckets[hash & table.numBucketsMinusOne];
-
-        if (expectedBucketLength > REPETITION_TABLE_BUCKET_SIZE)
-        {
-            EXPECT_EQ(bucket->stackLength, REPETITION_TABLE_BUCKET_SIZE);
-            ASSERT_NE(bucket->hashListStart, NULL);
-            ASSERT_NE(bucket->hashListEnd, NULL);
-        }
-        else
-        {
-            EXPECT_EQ(bucket->stackLength, expectedBucketLength);
-        }
-        EXPECT_FALSE(RepetitionTableContains(&table, hash));
-        EXPECT_TRUE(RepetitionTableContains(&table, hash - increment));
+        ASSERT_TRUE(RepetitionStackPush(&stack, hash));
+        EXPECT_EQ(stack.length, hash);
+        EXPECT_GE(stack.capacity, stack.length);
+        EXPECT_EQ(stack.hashes[hash - 1], hash);
     }
-    EXPECT_TRUE(RepetitionTableContains(&table, 0));
-    RepetitionTablePop(&table, 0);
-    EXPECT_FALSE(RepetitionTableContains(&table, 0));
 
-    RepetitionTablePush(&table, 0);
-    RepetitionTableClear(&table);
-    EXPECT_FALSE(RepetitionTableContains(&table, 0));
+    // Only positions at least four ply back, with the same side to move, are repetitions.
+    RepetitionStackStore(&stack, 0, 11);
+    EXPECT_TRUE(RepetitionStackContains(&stack, 0, 7, 100, 100));
+    EXPECT_TRUE(RepetitionStackContains(&stack, 0, 5, 100, 100));
+    EXPECT_TRUE(RepetitionStackContains(&stack, 0, 1, 100, 100));
+    EXPECT_FALSE(RepetitionStackContains(&stack, 0, 10, 100, 100));
+    EXPECT_FALSE(RepetitionStackContains(&stack, 0, 9, 100, 100));
+    EXPECT_FALSE(RepetitionStackContains(&stack, 0, 8, 100, 100));
+    EXPECT_FALSE(RepetitionStackContains(&stack, 0, 6, 100, 100));
+
+    // Positions before the last irreversible move can never repeat.
+    EXPECT_TRUE(RepetitionStackContains(&stack, 0, 7, 4, 100));
+    EXPECT_FALSE(RepetitionStackContains(&stack, 0, 5, 4, 100));
+    EXPECT_TRUE(RepetitionStackContains(&stack, 0, 5, 6, 100));
+    EXPECT_FALSE(RepetitionStackContains(&stack, 0, 7, 3, 100));
+
+    // Search path on top of the game history.
+    RepetitionStackStore(&stack, 1, 12);
+    RepetitionStackStore(&stack, 2, 13);
+    RepetitionStackStore(&stack, 3, 14);
+    RepetitionStackStore(&stack, 4, 15);
+    EXPECT_TRUE(RepetitionStackContains(&stack, 4, 11, 100, 100));
+    EXPECT_TRUE(RepetitionStackContains(&stack, 4, 9, 100, 100));
+    EXPECT_FALSE(RepetitionStackContains(&stack, 4, 13, 100, 100));
+    EXPECT_FALSE(RepetitionStackContains(&stack, 4, 12, 100, 100));
+    EXPECT_FALSE(RepetitionStackContains(&stack, 4, 9, 5, 100));
+
+    // Positions before a null move are not repetitions either.
+    EXPECT_TRUE(RepetitionStackContains(&stack, 4, 11, 100, 4));
+    EXPECT_FALSE(RepetitionStackContains(&stack, 4, 11, 100, 3));
+    EXPECT_FALSE(RepetitionStackContains(&stack, 4, 9, 100, 4));
+
+    RepetitionStack copy;
+    ASSERT_TRUE(RepetitionStackInitialize(&copy, 1));
+    ASSERT_TRUE(RepetitionStackCopy(&copy, &stack));
+    EXPECT_EQ(copy.length, stack.length);
+    for (size_t i = 0; i < stack.length; ++i)
+        EXPECT_EQ(copy.hashes[i], stack.hashes[i]);
+    RepetitionStackDestroy(&copy);
+
+    RepetitionStackPop(&stack);
+    EXPECT_EQ(stack.length, 9u);
+
+    RepetitionStackClear(&stack);
+    EXPECT_EQ(stack.length, 0u);
+    EXPECT_FALSE(RepetitionStackContains(&stack, 0, 1, 100, 100));
+
+    RepetitionStackDestroy(&stack);
+    EXPECT_EQ(stack.hashes, NULL);
+}
 
-    RepetitionTableDestroy(&table);
+void TestCuckoo()
+{
+    size_t numEntries = 0;
+    for (size_t i = 0; i < CUCKOO_TABLE_SIZE; ++i)
+    {
+        if (s_cuckooKeys[i] != 0)
+            numEntries++;
+    }
+    EXPECT_EQ(numEntries, (size_t)CUCKOO_NUM_MOVES);
+
+    // Reversible moves are found regardless of direction.
+    Square a;
+    Square b;
+    uint64_t key = ZobristGetPieceKey(White, Knight, SquareG1) ^ ZobristGetPieceKey(White, Knight, SquareF3) ^ ZobristGetPlayerToMoveKey();
+    ASSERT_TRUE(CuckooLookup(key, &a, &b));
+    EXPECT_EQ(a, SquareG1);
+    EXPECT_EQ(b, SquareF3);
+
+    key = ZobristGetPieceKey(Black, Queen, SquareH8) ^ ZobristGetPieceKey(Black, Queen, SquareA1) ^ ZobristGetPlayerToMoveKey();
+    ASSERT_TRUE(CuckooLookup(key, &a, &b));
+    EXPECT_EQ(a, SquareA1);
+    EXPECT_EQ(b, SquareH8);
+
+    // Moves which are not possible on an empty board, and pawn moves, are never found.
+    key = ZobristGetPieceKey(White, Rook, SquareA1) ^ ZobristGetPieceKey(White, Rook, SquareB2) ^ ZobristGetPlayerToMoveKey();
+    EXPECT_FALSE(CuckooLookup(key, &a, &b));
+    key = ZobristGetPieceKey(White, Pawn, SquareE2) ^ ZobristGetPieceKey(White, Pawn, SquareE3) ^ ZobristGetPlayerToMoveKey();
+    EXPECT_FALSE(CuckooLookup(key, &a, &b));
+
+    // The player to move must also be toggled.
+    key = ZobristGetPieceKey(White, Knight, SquareG1) ^ ZobristGetPieceKey(White, Knight, SquareF3);
+    EXPECT_FALSE(CuckooLookup(key, &a, &b));
 }
 
 static void CompareCharArrays(const char * a, size_t aLen, const char * b, size_t bLen)
@@ -346,10 +396,71 @@ void TestSort()
     CompareIntArrays(IntArrayF, 0, NULL, 0);
 }
 
+void TestMoveTiming()
+{
+    ASSERT_TRUE(MoveTimingInitialize());
+
+    MoveTimingRecord(500, MOVE_TIMING_NO_LIMIT, MOVE_TIMING_NO_LIMIT);  // 0.5 ms, untimed.
+    MoveTimingRecord(90000, 100, 150);                                  // Within both limits.
+    MoveTimingRecord(120000, 100, 150);                                 // Over the soft limit only.
+    MoveTimingRecord(153000, 100, 150);                                 // 3 ms over the hard limit.
+    MoveTimingRecord(20000000, 100, 150);                               // Far over the hard limit.
+
+    MoveTimingStats stats;
+    MoveTimingGetStats(&stats);
+    EXPECT_EQ(stats.moves, 5);
+    EXPECT_EQ(stats.maxMicroseconds, 20000000);
+    EXPECT_EQ(stats.latency[0], 1);
+    EXPECT_EQ(stats.latency[6], 1);
+    EXPECT_EQ(stats.latency[7], 2);
+    EXPECT_EQ(stats.latency[MOVE_TIMING_NUM_BUCKETS - 1], 1);
+    EXPECT_EQ(stats.timedMoves, 4);
+    EXPECT_EQ(stats.overSoftLimit, 3);
+    EXPECT_EQ(stats.overHardLimit, 2);
+    EXPECT_EQ(stats.maxOverrunMicroseconds, 20000000 - 150000);
+    EXPECT_EQ(stats.overrun[2], 1);
+    EXPECT_EQ(stats.overrun[MOVE_TIMING_NUM_BUCKETS - 1], 1);
+
+    MoveTimingClear();
+    MoveTimingGetStats(&stats);
+    EXPECT_EQ(stats.moves, 0);
+    EXPECT_EQ(stats.overHardLimit, 0);
+
+    uint32_t soft;
+    uint32_t hard;
+    MoveTimingGetLimits(MOVE_TIMING_NO_LIMIT, MOVE_TIMING_NO_LIMIT, MOVE_TIMING_NO_LIMIT, 0, 100, &soft, &hard);
+    EXPECT_EQ(soft, MOVE_TIMING_NO_LIMIT);
+    EXPECT_EQ(hard, MOVE_TIMING_NO_LIMIT);
+    MoveTimingGetLimits(MOVE_TIMING_NO_LIMIT, 60000, 1000, 0, 100, &soft, &hard); // 1500 ms per move plus increment.
+    EXPECT_EQ(hard, 2400);
+    EXPECT_EQ(soft, 1800);
+    MoveTimingGetLimits(500, MOVE_TIMING_NO_LIMIT, MOVE_TIMING_NO_LIMIT, 0, 100, &soft, &hard);
+    EXPECT_EQ(hard, 400);
+    EXPECT_EQ(soft, 400);
+
+    // Less time left than the move overhead: the limits must not wrap around.
+    MoveTimingGetLimits(MOVE_TIMING_NO_LIMIT, 1000, MOVE_TIMING_NO_LIMIT, 0, 100, &soft, &hard);
+    EXPECT_EQ(hard, MOVE_TIMING_MIN_LIMIT);
+    EXPECT_LE(soft, hard);
+    MoveTimingGetLimits(50, MOVE_TIMING_NO_LIMIT, MOVE_TIMING_NO_LIMIT, 0, 100, &soft, &hard);
+    EXPECT_EQ(hard, MOVE_TIMING_MIN_LIMIT);
+    EXPECT_EQ(soft, MOVE_TIMING_MIN_LIMIT);
+
+    // A 2 s move on such a limit is an overrun.
+    MoveTimingGetLimits(MOVE_TIMING_NO_LIMIT, 1000, MOVE_TIMING_NO_LIMIT, 0, 100, &soft, &hard);
+    MoveTimingRecord(2000000, soft, hard);
+    MoveTimingGetStats(&stats);
+    EXPECT_EQ(stats.overHardLimit, 1);
+    EXPECT_EQ(stats.maxOverrunMicroseconds, 2000000 - MOVE_TIMING_MIN_LIMIT * 1000);
+    MoveTimingClear();
+
+    MoveTimingDestroy();
+}
+
 // This test is most useful with Valgrind to check for memory leaks.
 void TestInit()
 {
-    ASSERT_EQ(Init(NULL), 0);
+    ASSERT_EQ(Init(), 0);
 
     ASSERT_TRUE(EvalInit(0x200000));
 
@@ -408,7 +519,7 @@ void CheckZobrist(const char * fen, uint64_t depth)
 
 void TestZobrist()
 {
-    Init(NULL);
+    Init();
 
     // Set up some complex positions and iterate over a large tree of moves, checking the Zobrist merge against the fully calculated value.
     // This is similar to perft but we're checking Zobrist instead of number of positions.
@@ -424,6 +535,318 @@ void TestZobrist()
     Cleanup();
 }
 
+// Compares the piece lookup (the mailbox, in the default board layout) against the piece tables.
+static void CheckPieceLookup(const Board * board)
+{
+    for (Square square = 0; square < NUM_SQUARES; ++square)
+    {
+        PieceType expectedType = None;
+        Player expectedPlayer = White;
+        for (Player player = White; player <= Black; ++player)
+        {
+            for (PieceType type = Pawn; type <= King; ++type)
+            {
+                if (BoardGetPieceTable(board, player, type) & SquareEncode(square))
+                {
+                    expectedType = type;
+                    expectedPlayer = player;
+                }
+            }
+        }
+
+        PieceType type;
+        Player player = White;
+        BoardGetPlayerPieceAtSquare(board, square, &type, &player);
+        EXPECT_EQ(type, expectedType);
+        EXPECT_EQ(player, expectedPlayer);
+    }
+}
+
+void CheckPieceLookupRecursive(Board * board, uint64_t curDepth, uint64_t maxDepth, uint64_t mm)
+{
+    Move * moves = &s_moves[mm];
+    Board nextBoard;
+
+    uint64_t numMoves = GetValidMoves(board, moves);
+
+    if (curDepth == maxDepth)
+        return;
+
+    for (uint64_t i = 0; i < numMoves; ++i)
+    {
+        nextBoard = *board;
+        MakeMove(&nextBoard, moves[i]);
+
+        CheckPieceLookup(&nextBoard);
+
+        CheckPieceLookupRecursive(&nextBoard, curDepth + 1, maxDepth, mm + numMoves);
+    }
+}
+
+void CheckPieceLookupFromFEN(const char * fen, uint64_t depth)
+{
+    Board board;
+    if (!ParseFEN(fen, &board))
+    {
+        printf("Invalid FEN\n");
+        return;
+    }
+
+    CheckPieceLookup(&board);
+    CheckPieceLookupRecursive(&board, 0, depth, 0);
+}
+
+void TestPieceLookup()
+{
+    Init();
+
+    Board board;
+    BoardInitializeStartingPosition(&board);
+    CheckPieceLookup(&board);
+
+    // Covers castling, en passant, promotions and captures of every piece type.
+    CheckPieceLookupFromFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -", 3);
+    CheckPieceLookupFromFEN("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -", 4);
+    CheckPieceLookupFromFEN("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 3);
+    CheckPieceLookupFromFEN("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 3);
+
+    Cleanup();
+}
+
+void CheckAttackMap(const Board * board)
+{
+    Player opponent = !board->playerToMove;
+    const uint64_t * friendlyPawnAttacks = (board->playerToMove == White) ? s_pawnAttackBitboardWhite : s_pawnAttackBitboardBlack;
+    EncodedSquare queens = BoardGetPieceTable(board, opponent, Queen);
+    AttackMap attackMap;
+    AttackMapInitialize(&attackMap, board, opponent);
+
+    // Every square must match a lookup from the square back towards the opponent's pieces.
+    for (Square square = 0; square < NUM_SQUARES; ++square)
+    {
+        EncodedSquare mask = SquareEncode(square);
+        EXPECT_EQ((attackMap.byPiece[Pawn] & mask) != 0, (GetPawnCaptureMoves(friendlyPawnAttacks, square) & BoardGetPieceTable(board, opponent, Pawn)) != 0);
+        EXPECT_EQ((attackMap.byPiece[Knight] & mask) != 0, (GetKnightMoves(square) & BoardGetPieceTable(board, opponent, Knight)) != 0);
+        EXPECT_EQ((attackMap.byPiece[Bishop] & mask) != 0, (GetBishopMoves(BoardGetOccupancy(board), square) & BoardGetPieceTable(board, opponent, Bishop)) != 0);
+        EXPECT_EQ((attackMap.byPiece[Rook] & mask) != 0, (GetRookMoves(BoardGetOccupancy(board), square) & BoardGetPieceTable(board, opponent, Rook)) != 0);
+        EXPECT_EQ((attackMap.byPiece[Queen] & mask) != 0, (GetQueenMoves(BoardGetOccupancy(board), square) & queens) != 0);
+        EXPECT_EQ((attackMap.byPiece[King] & mask) != 0, (GetKingMoves(square) & BoardGetPieceTable(board, opponent, King)) != 0);
+    }
+
+    // The set-wise slider fills must produce the same union as the per-square lookups.
+    EncodedSquare bishopsQueens = BoardGetPlayerPieceTable(board, opponent, PIECE_TABLE_BISHOPS_QUEENS);
+    EncodedSquare rooksQueens = BoardGetPlayerPieceTable(board, opponent, PIECE_TABLE_ROOKS_QUEENS);
+    EncodedSquare bishopAttacks = 0;
+    EncodedSquare rookAttacks = 0;
+    for (EncodedSquare pieces = bishopsQueens; pieces; pieces = intrinsic_blsr64(pieces))
+        bishopAttacks |= GetBishopMoves(BoardGetOccupancy(board), SquareDecodeLowest(pieces));
+    for (EncodedSquare pieces = rooksQueens; pieces; pieces = intrinsic_blsr64(pieces))
+        rookAttacks |= GetRookMoves(BoardGetOccupancy(board), SquareDecodeLowest(pieces));
+    EXPECT_EQ(GetSetwiseBishopMoves(bishopsQueens, BoardGetOccupancy(board)), bishopAttacks);
+    EXPECT_EQ(GetSetwiseRookMoves(rooksQueens, BoardGetOccupancy(board)), rookAttacks);
+
+    EXPECT_EQ(attackMap.all, attackMap.byPiece[Pawn] | attackMap.byPiece[Knight] | attackMap.byPiece[Bishop] |
+        attackMap.byPiece[Rook] | attackMap.byPiece[Queen] | attackMap.byPiece[King]);
+}
+
+void CheckCheckInfoRecursive(Board * board, uint64_t curDepth, uint64_t maxDepth, uint64_t mm)
+{
+    Move * moves = &s_moves[mm];
+    Board nextBoard;
+    CheckInfo checkInfo;
+
+    CheckInfoInitialize(&checkInfo, board);
+    EXPECT_EQ(checkInfo.checkers != 0, KingIsAttacked(board, board->playerToMove));
+    CheckAttackMap(board);
+
+    uint64_t numMoves = GetPseudoLegalMoves(board, moves);
+    uint64_t numLegalMoves = 0;
+    for (uint64_t i = 0; i < numMoves; ++i)
+    {
+        bool legal = IsMoveLegal(board, &checkInfo, moves[i]);
+        EXPECT_EQ(legal, IsMoveValid(board, moves[i]));
+        if (!legal)
+            continue;
+        numLegalMoves++;
+
+        nextBoard = *board;
+        MakeMove(&nextBoard, moves[i]);
+        EXPECT_EQ(MoveGivesCheck(board, &checkInfo, moves[i]), KingIsAttacked(&nextBoard, nextBoard.playerToMove));
+
+        if (curDepth + 1 < maxDepth)
+            CheckCheckInfoRecursive(&nextBoard, curDepth + 1, maxDepth, mm + numMoves);
+    }
+
+    // When in check, the evasions are exactly the legal moves.
+    if (checkInfo.checkers)
+    {
+        Move * evasions = &s_moves[mm + numMoves];
+        uint64_t numEvasions = GetEvasions(board, evasions);
+        EXPECT_EQ(numEvasions, numLegalMoves);
+        for (uint64_t i = 0; i < numEvasions; ++i)
+            EXPECT_TRUE(IsMoveValid(board, evasions[i]));
+    }
+}
+
+void CheckCheckInfo(const char * fen, uint64_t depth)
+{
+    Board board;
+    if (!ParseFEN(fen, &board))
+    {
+        printf("Invalid FEN\n");
+        return;
+    }
+
+    CheckCheckInfoRecursive(&board, 0, depth, 0);
+}
+
+void TestCheckInfo()
+{
+    Init();
+
+    // Legality, gives-check, evasions and attack maps from the per-position data must agree with the brute force versions.
+    CheckCheckInfo("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 0", 4);
+    CheckCheckInfo("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -", 3);
+    CheckCheckInfo("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -", 5);
+    CheckCheckInfo("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 3);
+    CheckCheckInfo("r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1", 3);
+    CheckCheckInfo("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 3);
+    CheckCheckInfo("r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 3);
+    CheckCheckInfo("8/8/8/K2pP2r/8/8/8/7k w - d6 0 1", 2); // En passant which exposes the king along the rank.
+    CheckCheckInfo("4k3/8/8/3pP3/4K3/8/8/8 w - d6 0 1", 2); // En passant capturing the checking pawn.
+    CheckCheckInfo("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", 3); // Castling with check from the rook.
+    CheckCheckInfo("4k3/8/8/8/1b6/8/8/r3K3 w - - 0 1", 2); // Double check.
+
+    Cleanup();
+}
+
+static uint64_t SlidingAttacks(Square square, uint64_t occupied, const int directions[4][2])
+{
+    uint64_t attacks = 0;
+    for (int d = 0; d < 4; ++d)
+    {
+        int r = (int) SquareGetRank(square) + directions[d][0];
+        int f = (int) SquareGetFile(square) + directions[d][1];
+        while (r >= 0 && r < 8 && f >= 0 && f < 8)
+        {
+            EncodedSquare s = SquareEncodeRankFile((Rank) r, (File) f);
+            attacks |= s;
+            if (occupied & s)
+                break;
+            r += directions[d][0];
+            f += directions[d][1];
+        }
+    }
+    return attacks;
+}
+
+static void CheckSliderBackend(SliderBackend backend)
+{
+    static const int rookDirections[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+    static const int bishopDirections[4][2] = { { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
+
+    ASSERT_TRUE(SetSliderBackend(backend));
+
+    RandomSeed(1070372);
+    for (Square square = 0; square < NUM_SQUARES; ++square)
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            // Sparse and dense boards.
+            uint64_t occupied = (i & 1) ? (RandomU64() & RandomU64()) : (RandomU64() | RandomU64());
+            EXPECT_EQ(GetRookMoves(occupied, square), SlidingAttacks(square, occupied, rookDirections));
+            EXPECT_EQ(GetBishopMoves(occupied, square), SlidingAttacks(square, occupied, bishopDirections));
+        }
+    }
+}
+
+// The queen has more targets than a vector of moves holds (16), so AVX-512 builds serialize its moves in two steps.
+void TestMoveSerialization()
+{
+    Init();
+
+    Board board;
+    ASSERT_TRUE(ParseFEN("7k/8/8/3Q4/8/8/8/K7 w - - 0 1", &board));
+
+    Move moves[256];
+    memset(moves, 0xFF, sizeof(moves));
+    uint8_t numMoves = GetValidMoves(&board, moves);
+    EXPECT_EQ(numMoves, 30);
+
+    // Nothing may be written past the last move.
+    const uint8_t * bytes = (const uint8_t *)moves;
+    for (size_t i = numMoves * sizeof(Move); i < sizeof(moves); ++i)
+        EXPECT_EQ(bytes[i], 0xFF);
+
+    EncodedSquare targets = 0;
+    int numQueenMoves = 0;
+    for (uint8_t i = 0; i < numMoves; ++i)
+    {
+        if (moves[i].piece != Queen)
+            continue;
+        EXPECT_EQ(moves[i].from, SquareD5);
+        EXPECT_EQ(moves[i].promotion, None);
+        targets |= SquareEncode(moves[i].to);
+        numQueenMoves++;
+    }
+    EXPECT_EQ(numQueenMoves, 27);
+    EXPECT_EQ(intrinsic_popcnt64(targets), 27);
+    EXPECT_EQ(targets & SquareEncode(SquareD5), 0);
+
+    Cleanup();
+}
+
+void TestSliderBackends()
+{
+    Init();
+
+    EXPECT_TRUE(SliderBackendSupported(GetPreferredSliderBackend()));
+
+    CheckSliderBackend(SliderBackendMagic);
+    if (SliderBackendSupported(SliderBackendPext))
+        CheckSliderBackend(SliderBackendPext);
+
+    // Switching back must not rebuild or lose anything.
+    CheckSliderBackend(SliderBackendMagic);
+
+    Cleanup();
+}
+
+void CheckPerft(const char * fen, uint32_t depth, uint64_t expectedNodes)
+{
+    Board board;
+    ASSERT_TRUE(ParseFEN(fen, &board));
+
+    // The split must not depend on the number of threads, and the hash table must not change the counts.
+    for (size_t hashSizeMB = 0; hashSizeMB <= 1; ++hashSizeMB)
+    {
+        ASSERT_TRUE(PerftSetHashSize(hashSizeMB));
+        for (uint32_t numThreads = 1; numThreads <= 4; numThreads *= 2)
+        {
+            uint64_t nodes = 0;
+            EXPECT_TRUE(Perft(&board, depth, numThreads, false, &nodes));
+            EXPECT_EQ(nodes, expectedNodes);
+        }
+    }
+    PerftDestroy();
+}
+
+void TestPerft()
+{
+    Init();
+
+    CheckPerft("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 0, 1);
+    CheckPerft("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 1, 20);
+    CheckPerft("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 2, 400);
+    CheckPerft("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 4, 197281);
+    CheckPerft("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 3, 97862);
+    CheckPerft("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624);
+    CheckPerft("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 3, 9467);
+    CheckPerft("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 3, 62379);
+
+    Cleanup();
+}
+
 int main(int argc, char ** argv)
 {
     ZobristGenerate();
@@ -431,9 +854,16 @@ int main(int argc, char ** argv)
     TestMoves();
     TestTransposition();
     TestRepetition();
+    TestCuckoo();
     TestSort();
+    TestMoveTiming();
     TestInit();
     TestZobrist();
+    TestPieceLookup();
+    TestCheckInfo();
+    TestMoveSerialization();
+    TestSliderBackends();
+    TestPerft();
     if (s_fail)
         printf("Unit tests failed.\n");
     return s_fail ? 1 : 0;